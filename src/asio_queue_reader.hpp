@@ -0,0 +1,128 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/system/error_code.hpp>
+#include <memory>
+#include <unistd.h>
+
+#include "eventfd_wait.hpp"
+#include "wait_strategy.hpp"
+
+namespace common {
+    /*
+     * Consumes a BlockingQueue whose consumer wait policy is EventFdWait
+     * from an asio io_context, with no polling timer and zero idle CPU.
+     *
+     * When signalled it drains up to `batch_limit` elements into
+     * `handler(value_type&&)`. If the batch was full it re-posts itself so
+     * other handlers on the loop get a turn; otherwise it arms the
+     * notifier, re-checks the queue, and goes back to waiting on the
+     * eventfd. One wake-up (and one producer syscall) per burst.
+     *
+     * Owned through a shared_ptr like the websocket session, since pending
+     * asio operations keep it alive.
+    */
+    template <typename BQueue, typename Handler>
+    class AsioQueueReader : public std::enable_shared_from_this<AsioQueueReader<BQueue, Handler>> {
+    public:
+        AsioQueueReader(boost::asio::io_context& ioc, BQueue& queue, Handler handler, size_t batch_limit) :
+            queue_(queue),
+            notifier_(queue.consumer_wait()),
+            // the descriptor closes what it owns, so give it its own fd
+            stream_(ioc, ::dup(notifier_.fd())),
+            handler_(std::move(handler)),
+            batch_limit_(batch_limit) {}
+
+        void start() {
+            boost::asio::post(
+                stream_.get_executor(),
+                [self = this->shared_from_this()]() { self->on_ready(); }
+            );
+        }
+
+        // safe to call from any thread
+        void stop() {
+            boost::asio::post(
+                stream_.get_executor(),
+                [self = this->shared_from_this()]() {
+                    self->stopped_ = true;
+                    boost::system::error_code ec;
+                    self->stream_.cancel(ec);
+                }
+            );
+        }
+
+        // wake-ups that found at least one element / found none. io thread only
+        size_t wakeups() const {
+            return wakeups_;
+        }
+
+        size_t empty_wakeups() const {
+            return empty_wakeups_;
+        }
+
+    private:
+        size_t drain() {
+            size_t n = 0;
+            while (n < batch_limit_) {
+                auto val = queue_.try_pop();
+                if (!val.has_value()) {
+                    break;
+                }
+                handler_(std::move(*val));
+                ++n;
+            }
+            return n;
+        }
+
+        void on_signal() {
+            notifier_.clear();
+            on_ready();
+        }
+
+        void on_ready() {
+            if (stopped_) {
+                return;
+            }
+            size_t n = drain();
+            ++(n > 0 ? wakeups_ : empty_wakeups_);
+            for (;;) {
+                if (stopped_) {
+                    return;
+                }
+                if (n == batch_limit_) {
+                    // more may be waiting: yield to the loop, then continue
+                    start();
+                    return;
+                }
+                notifier_.arm();
+                n = drain();
+                if (n == 0) {
+                    break;
+                }
+                // raced with a producer; a stale signal only costs one
+                // empty wake-up later
+                notifier_.disarm();
+            }
+            stream_.async_wait(
+                boost::asio::posix::stream_descriptor::wait_read,
+                [self = this->shared_from_this()](const boost::system::error_code& ec) {
+                    if (!ec) {
+                        self->on_signal();
+                    }
+                }
+            );
+        }
+
+        BQueue& queue_;
+        EventFdWait& notifier_;
+        boost::asio::posix::stream_descriptor stream_;
+        Handler handler_;
+        const size_t batch_limit_;
+        bool stopped_ = false;
+        size_t wakeups_ = 0;
+        size_t empty_wakeups_ = 0;
+    };
+}
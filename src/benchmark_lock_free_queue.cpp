@@ -1,19 +1,236 @@
-// #include <benchmark/benchmark.h>
-// #include <thread>
-
-// static void BM_ThreadedFunction(benchmark::State& state) {
-//     for (auto _ : state) {
-//         int counter = 0;
-//         std::thread t([&] { counter++; });
-//         t.join();
-//         benchmark::DoNotOptimize(counter);
-//     }
-// }
-// // Register the function as a benchmark
-// BENCHMARK(BM_ThreadedFunction);
-
-// BENCHMARK_MAIN();
-
-int main() {
-    return 0;
-}
\ No newline at end of file
+#include "thread_utils.hpp"
+#include "lock_free_queue.hpp"
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Element of N bytes. The first word carries the value so the consumer
+// can look for the sentinel without touching the rest.
+template <size_t N>
+struct Payload {
+    static_assert(N >= sizeof(int64_t) && N % sizeof(int64_t) == 0);
+    int64_t value_;
+    std::array<int64_t, N / sizeof(int64_t) - 1> pad_;
+};
+
+static constexpr int64_t sentinel = -1;
+static constexpr int queue_capacity = 1024;
+
+/*
+ * Producer/consumer core pairs for the two-thread benchmarks, -1 meaning
+ * unpinned. Override with LFQUEUE_BENCH_CORES="p:c,p:c,...", e.g. "2:3,2:10"
+ * to compare siblings on one socket against a cross-socket pair. Pairs
+ * naming a core this machine does not have are skipped.
+*/
+static std::vector<std::pair<int, int>> core_pairs() {
+    std::vector<std::pair<int, int>> pairs;
+    if (const char* env = std::getenv("LFQUEUE_BENCH_CORES")) {
+        std::string spec(env);
+        size_t pos = 0;
+        while (pos < spec.size()) {
+            size_t end = spec.find(',', pos);
+            if (end == std::string::npos) {
+                end = spec.size();
+            }
+            const std::string pair = spec.substr(pos, end - pos);
+            const size_t colon = pair.find(':');
+            if (colon != std::string::npos) {
+                pairs.emplace_back(std::stoi(pair.substr(0, colon)), std::stoi(pair.substr(colon + 1)));
+            }
+            pos = end + 1;
+        }
+    } else {
+        pairs = {{-1, -1}, {0, 1}, {0, 2}};
+    }
+    const int num_cores = static_cast<int>(std::thread::hardware_concurrency());
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [num_cores](const auto& p) {
+        return p.first >= num_cores || p.second >= num_cores;
+    }), pairs.end());
+    return pairs;
+}
+
+static void CorePairs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"producer_core", "consumer_core"});
+    for (const auto& [producer, consumer] : core_pairs()) {
+        b->Args({producer, consumer});
+    }
+}
+
+// Single thread: one push and one pop per iteration, i.e. the bare cost
+// of the two operations with every line already in L1.
+template <typename T>
+static void BM_LFQueuePushPop(benchmark::State& state) {
+    common::LFQueue<T> q(queue_capacity);
+    T elem{};
+    for (auto _ : state) {
+        q.push(elem);
+        auto val = q.pop();
+        benchmark::DoNotOptimize(val);
+        ++elem.value_;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_LFQueuePushPop, Payload<8>);
+BENCHMARK_TEMPLATE(BM_LFQueuePushPop, Payload<16>);
+BENCHMARK_TEMPLATE(BM_LFQueuePushPop, Payload<32>);
+BENCHMARK_TEMPLATE(BM_LFQueuePushPop, Payload<64>);
+BENCHMARK_TEMPLATE(BM_LFQueuePushPop, Payload<128>);
+BENCHMARK_TEMPLATE(BM_LFQueuePushPop, Payload<256>);
+
+// As BM_LFQueuePushPop for the compile-time capacity ring, which masks
+// instead of dividing and keeps cached copies of the other cursor.
+template <typename T>
+static void BM_FixedLFQueuePushPop(benchmark::State& state) {
+    // up to 256 KiB of inline slots: keep it off the stack
+    auto q = std::make_unique<common::FixedLFQueue<T, queue_capacity>>();
+    T elem{};
+    for (auto _ : state) {
+        q->push(elem);
+        auto val = q->pop();
+        benchmark::DoNotOptimize(val);
+        ++elem.value_;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_FixedLFQueuePushPop, Payload<8>);
+BENCHMARK_TEMPLATE(BM_FixedLFQueuePushPop, Payload<16>);
+BENCHMARK_TEMPLATE(BM_FixedLFQueuePushPop, Payload<32>);
+BENCHMARK_TEMPLATE(BM_FixedLFQueuePushPop, Payload<64>);
+BENCHMARK_TEMPLATE(BM_FixedLFQueuePushPop, Payload<128>);
+BENCHMARK_TEMPLATE(BM_FixedLFQueuePushPop, Payload<256>);
+
+template <typename Queue>
+void consumeUntilSentinel(Queue& q) {
+    for (;;) {
+        auto val = q.pop();
+        benchmark::DoNotOptimize(val);
+        if (val.has_value() && val->value_ == sentinel) {
+            return;
+        }
+    }
+}
+
+// Two threads: the benchmark thread produces, a consumer started with
+// create_and_start_thread pops until it sees the sentinel. The consumer
+// is started quietly so the report stays clean. The benchmark thread is
+// only pinned for the run, so later unpinned runs really are unpinned.
+template <typename T, typename Queue>
+static void run_throughput(benchmark::State& state, Queue& q) {
+    common::ScopedThreadCore pin(state.range(0));
+    std::thread* consumer = common::create_and_start_thread(
+        common::ThreadLog::Quiet, state.range(1), "consumer", consumeUntilSentinel<Queue>, q
+    );
+
+    T elem{};
+    for (auto _ : state) {
+        while (!q.push(elem));
+        ++elem.value_;
+    }
+    elem.value_ = sentinel;
+    while (!q.push(elem));
+    consumer->join();
+    delete consumer;
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(T));
+}
+
+// Templated on the queue's ExactSize flag to show the cost of the shared
+// size counter.
+template <typename T, bool ExactSize>
+static void BM_LFQueueThroughput(benchmark::State& state) {
+    common::LFQueue<T, ExactSize> q(queue_capacity);
+    run_throughput<T>(state, q);
+}
+BENCHMARK_TEMPLATE(BM_LFQueueThroughput, Payload<8>, false)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LFQueueThroughput, Payload<8>, true)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LFQueueThroughput, Payload<16>, false)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LFQueueThroughput, Payload<32>, false)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LFQueueThroughput, Payload<64>, false)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LFQueueThroughput, Payload<128>, false)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LFQueueThroughput, Payload<256>, false)->Apply(CorePairs)->UseRealTime();
+
+// The cached cursors matter most here: in steady state each side only
+// reloads the other's cursor when the ring looks full or empty.
+template <typename T>
+static void BM_FixedLFQueueThroughput(benchmark::State& state) {
+    auto q = std::make_unique<common::FixedLFQueue<T, queue_capacity>>();
+    run_throughput<T>(state, *q);
+}
+BENCHMARK_TEMPLATE(BM_FixedLFQueueThroughput, Payload<8>)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FixedLFQueueThroughput, Payload<64>)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FixedLFQueueThroughput, Payload<256>)->Apply(CorePairs)->UseRealTime();
+
+template <typename T>
+void echoUntilSentinel(common::LFQueue<T>& ping, common::LFQueue<T>& pong) {
+    for (;;) {
+        auto val = ping.pop();
+        if (!val.has_value()) {
+            continue;
+        }
+        while (!pong.push(*val));
+        if (val->value_ == sentinel) {
+            return;
+        }
+    }
+}
+
+// Round trip: the benchmark thread pushes onto `ping`, an echo thread
+// pushes the element back onto `pong`, and the benchmark thread waits
+// for it. Every round trip is timed individually (the clock reads add a
+// few tens of ns) and reported as p50/p99/p99.9/max in ns.
+template <typename T>
+static void BM_LFQueuePingPong(benchmark::State& state) {
+    common::LFQueue<T> ping(queue_capacity);
+    common::LFQueue<T> pong(queue_capacity);
+    common::ScopedThreadCore pin(state.range(0));
+    std::thread* echo = common::create_and_start_thread(
+        common::ThreadLog::Quiet, state.range(1), "echo", echoUntilSentinel<T>, ping, pong
+    );
+
+    std::vector<int64_t> samples;
+    samples.reserve(1 << 20);
+    T elem{};
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        while (!ping.push(elem));
+        std::optional<T> val;
+        do {
+            val = pong.pop();
+        } while (!val.has_value());
+        const auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        ++elem.value_;
+    }
+    elem.value_ = sentinel;
+    while (!ping.push(elem));
+    while (!pong.pop().has_value());
+    echo->join();
+    delete echo;
+
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples](double p) {
+        return static_cast<double>(samples[static_cast<size_t>(p * (samples.size() - 1))]);
+    };
+    state.counters["p50_ns"] = percentile(0.50);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p99.9_ns"] = percentile(0.999);
+    state.counters["max_ns"] = static_cast<double>(samples.back());
+}
+BENCHMARK_TEMPLATE(BM_LFQueuePingPong, Payload<8>)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LFQueuePingPong, Payload<64>)->Apply(CorePairs)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LFQueuePingPong, Payload<256>)->Apply(CorePairs)->UseRealTime();
+
+BENCHMARK_MAIN();
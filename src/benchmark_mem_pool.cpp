@@ -0,0 +1,125 @@
+#include "growable_mem_pool.hpp"
+#include "mem_pool.hpp"
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Order-pool churn at a fixed occupancy: every iteration frees a random
+// live object and allocates a new one, so free blocks end up scattered
+// across the store the way they are after a day of fills and cancels.
+// A linear scan for a free block gets slower the fuller the pool is;
+// the free list must not.
+
+struct Order {
+    int64_t id_;
+    int64_t price_;
+    int64_t qty_;
+    char side_;
+};
+
+static constexpr int pool_capacity = 100'000;
+
+template <typename Policy>
+static void BM_MemPoolChurn(benchmark::State& state) {
+    const double occupancy = state.range(0) / 100.0;
+    const size_t live_count = static_cast<size_t>(pool_capacity * occupancy);
+
+    common::MemPool<Order, Policy> pool(pool_capacity);
+    // fill completely, then free a random subset down to the occupancy
+    std::vector<Order*> live;
+    live.reserve(pool_capacity);
+    for (int i = 0; i < pool_capacity; ++i) {
+        live.push_back(pool.allocate(Order{i, 0, 0, 'B'}));
+    }
+    std::mt19937_64 rng(42);
+    std::shuffle(live.begin(), live.end(), rng);
+    while (live.size() > live_count) {
+        pool.deallocate(live.back());
+        live.pop_back();
+    }
+
+    // victims chosen up front so the generator stays out of the loop
+    std::vector<size_t> victims(1 << 16);
+    if (!live.empty()) {
+        std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+        for (auto& v : victims) {
+            v = pick(rng);
+        }
+    }
+
+    int64_t id = pool_capacity;
+    size_t next = 0;
+    for (auto _ : state) {
+        if (live.empty()) {
+            Order* order = pool.allocate(Order{id++, 0, 0, 'B'});
+            benchmark::DoNotOptimize(order);
+            pool.deallocate(order);
+            continue;
+        }
+        const size_t victim = victims[next++ & (victims.size() - 1)];
+        pool.deallocate(live[victim]);
+        live[victim] = pool.allocate(Order{id++, 0, 0, 'B'});
+        benchmark::DoNotOptimize(live[victim]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_MemPoolChurn, common::UncheckedPool)
+    ->ArgName("occupancy_pct")->Arg(0)->Arg(25)->Arg(50)->Arg(75)->Arg(90)->Arg(99);
+BENCHMARK_TEMPLATE(BM_MemPoolChurn, common::CheckedPool)
+    ->ArgName("occupancy_pct")->Arg(0)->Arg(25)->Arg(50)->Arg(75)->Arg(90)->Arg(99);
+
+// Order burst at 10x the usual volume: a GrowableMemPool sized for one
+// slab of `slab_capacity` orders takes ten slabs' worth. Every allocate
+// that had to grow the pool is timed on its own, reported as max_grow_ns,
+// alongside how many grows found no spare ready. With paced=1 the burst
+// pauses after each slab long enough for the pre-allocator to catch up,
+// as a real order flow usually does; paced=0 is the worst case.
+static void BM_GrowableMemPoolBurst(benchmark::State& state) {
+    const int slab_capacity = static_cast<int>(state.range(0));
+    const bool paced = state.range(1) != 0;
+    int64_t max_grow_ns = 0;
+    size_t grows = 0, sync_grows = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto* pool = new common::GrowableMemPool<Order, common::UncheckedPool>(slab_capacity);
+        state.ResumeTiming();
+
+        for (int64_t i = 0; i < 10 * slab_capacity; ++i) {
+            if (pool->size() == pool->capacity()) {
+                if (paced) {
+                    state.PauseTiming();
+                    while (!pool->spare_ready()) {
+                        std::this_thread::yield();
+                    }
+                    state.ResumeTiming();
+                }
+                const auto start = std::chrono::steady_clock::now();
+                benchmark::DoNotOptimize(pool->allocate(Order{i, 0, 0, 'B'}));
+                const auto end = std::chrono::steady_clock::now();
+                max_grow_ns = std::max<int64_t>(max_grow_ns,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+                continue;
+            }
+            benchmark::DoNotOptimize(pool->allocate(Order{i, 0, 0, 'B'}));
+        }
+
+        state.PauseTiming();
+        grows += pool->slab_grows();
+        sync_grows += pool->sync_grows();
+        delete pool;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * 10 * slab_capacity);
+    state.counters["max_grow_ns"] = static_cast<double>(max_grow_ns);
+    state.counters["sync_grow_pct"] = grows ? 100.0 * sync_grows / grows : 0.0;
+}
+BENCHMARK(BM_GrowableMemPoolBurst)->ArgNames({"slab_capacity", "paced"})
+    ->Args({10'000, 1})->Args({10'000, 0})->Args({100'000, 1})->Args({100'000, 0});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,85 @@
+#include "thread_utils.hpp"
+#include "mpmc_queue.hpp"
+
+#include <benchmark/benchmark.h>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// Every benchmark thread is both a producer and a consumer: each iteration
+// pushes one element and pops one (not necessarily its own), so the queue
+// never fills or drains for good and all threads contend on both cursors.
+// Thread i is pinned to core i modulo the number of cores for the run,
+// and gets its old affinity back afterwards.
+
+static constexpr int queue_capacity = 1024;
+
+static int benchmark_thread_core(const benchmark::State& state) {
+    const unsigned num_cores = std::thread::hardware_concurrency();
+    return num_cores > 0 ? state.thread_index() % num_cores : 0;
+}
+
+static common::MPMCQueue<int64_t>* mpmc_queue;
+
+static void BM_MPMCQueuePushPop(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        mpmc_queue = new common::MPMCQueue<int64_t>(queue_capacity);
+    }
+    common::ScopedThreadCore pin(benchmark_thread_core(state));
+    int64_t i = 0;
+    for (auto _ : state) {
+        while (!mpmc_queue->push(i));
+        std::optional<int64_t> val;
+        do {
+            val = mpmc_queue->pop();
+        } while (!val.has_value());
+        benchmark::DoNotOptimize(val);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete mpmc_queue;
+    }
+}
+
+// the baseline the MPMC queue replaces
+struct MutexQueue {
+    std::mutex mutex_;
+    std::deque<int64_t> queue_;
+};
+
+static MutexQueue* mutex_queue;
+
+static void BM_MutexQueuePushPop(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        mutex_queue = new MutexQueue;
+    }
+    common::ScopedThreadCore pin(benchmark_thread_core(state));
+    int64_t i = 0;
+    for (auto _ : state) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_queue->mutex_);
+            mutex_queue->queue_.push_back(i);
+        }
+        std::optional<int64_t> val;
+        do {
+            std::lock_guard<std::mutex> lock(mutex_queue->mutex_);
+            if (!mutex_queue->queue_.empty()) {
+                val = mutex_queue->queue_.front();
+                mutex_queue->queue_.pop_front();
+            }
+        } while (!val.has_value());
+        benchmark::DoNotOptimize(val);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete mutex_queue;
+    }
+}
+
+BENCHMARK(BM_MPMCQueuePushPop)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_MutexQueuePushPop)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,91 @@
+#include "lock_free_queue.hpp"
+#include "mpsc_queue.hpp"
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Fan-in of N producer threads into the benchmark (consumer) thread.
+// Producers push as fast as they can until told to stop; each benchmark
+// iteration is one element received by the consumer.
+
+static constexpr int queue_capacity = 1024;
+
+static void BM_MPSCQueueFanIn(benchmark::State& state) {
+    const int num_producers = state.range(0);
+    common::MPSCQueue<int64_t> q(queue_capacity);
+    std::atomic<bool> stop{false};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&q, &stop]() {
+            int64_t i = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (q.push(i)) {
+                    ++i;
+                }
+            }
+        });
+    }
+
+    for (auto _ : state) {
+        std::optional<int64_t> val;
+        do {
+            val = q.pop();
+        } while (!val.has_value());
+        benchmark::DoNotOptimize(val);
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : producers) {
+        t.join();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// the alternative: one SPSC ring per producer, polled round-robin
+static void BM_LFQueueRoundRobinFanIn(benchmark::State& state) {
+    const int num_producers = state.range(0);
+    std::vector<std::unique_ptr<common::LFQueue<int64_t>>> queues;
+    for (int p = 0; p < num_producers; ++p) {
+        queues.push_back(std::make_unique<common::LFQueue<int64_t>>(queue_capacity / num_producers));
+    }
+    std::atomic<bool> stop{false};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([q = queues[p].get(), &stop]() {
+            int64_t i = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (q->push(i)) {
+                    ++i;
+                }
+            }
+        });
+    }
+
+    size_t next = 0;
+    for (auto _ : state) {
+        std::optional<int64_t> val;
+        do {
+            val = queues[next]->pop();
+            if (++next == queues.size()) {
+                next = 0;
+            }
+        } while (!val.has_value());
+        benchmark::DoNotOptimize(val);
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : producers) {
+        t.join();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MPSCQueueFanIn)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+BENCHMARK(BM_LFQueueRoundRobinFanIn)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "macros.hpp"
+#include "pow2.hpp"
+
+namespace common {
+    // a cursor on its own cache line. counts sequences processed, so the
+    // next sequence to process is `value_`
+    struct alignas(hardware_destructive_interference_size) Sequence {
+        std::atomic<size_t> value_{0};
+
+        size_t load() const {
+            return value_.load(std::memory_order_acquire);
+        }
+
+        void store(size_t value) {
+            value_.store(value, std::memory_order_release);
+        }
+    };
+
+    /*
+     * Single-producer, multi-consumer broadcast ring (Disruptor style).
+     *
+     * Every consumer sees every element, read in place from the same slot,
+     * so one event reaches N readers without N copies. Each consumer has
+     * its own padded cursor. The producer only reuses a slot once every
+     * consumer has moved past it, i.e. it gates on the slowest one.
+     *
+     * Consumers can depend on other consumers: a consumer registered with
+     * `depends_on = {&book}` only sees sequence `s` after `book` has
+     * finished with it, so it can read whatever `book` derived from `s`.
+     *
+     * Slots are preallocated and reused, so T must be default
+     * constructible; the producer overwrites them in place.
+     *
+     * All consumers must be added before the producer starts publishing.
+    */
+    template <typename T>
+    class BroadcastRing {
+    public:
+        class Consumer {
+        public:
+            Consumer(const Consumer&) = delete;
+            Consumer(const Consumer&&) = delete;
+            Consumer& operator=(const Consumer&) = delete;
+            Consumer& operator=(const Consumer&&) = delete;
+
+            // next element for this consumer, or nullptr if it is caught up
+            // with its upstream. stays valid until consume()
+            const T* peek() {
+                const size_t next = cursor_.value_.load(std::memory_order_relaxed);
+                if (next == cached_available_) {
+                    cached_available_ = available();
+                    if (next == cached_available_) {
+                        return nullptr;
+                    }
+                }
+                return &ring_.store_[next & ring_.mask_];
+            }
+
+            void consume() {
+                cursor_.store(cursor_.value_.load(std::memory_order_relaxed) + 1);
+            }
+
+            // calls `callback(const T&)` on up to `max` available elements,
+            // then advances the cursor once for the whole batch
+            template <typename F>
+            size_t poll(F&& callback, size_t max) {
+                const size_t next = cursor_.value_.load(std::memory_order_relaxed);
+                if (cached_available_ - next < max) {
+                    cached_available_ = available();
+                }
+                const size_t end = next + std::min(max, cached_available_ - next);
+                for (size_t seq = next; seq < end; ++seq) {
+                    callback(ring_.store_[seq & ring_.mask_]);
+                }
+                if (end != next) {
+                    cursor_.store(end);
+                }
+                return end - next;
+            }
+
+            // number of sequences this consumer has finished with
+            size_t sequence() const {
+                return cursor_.load();
+            }
+
+        private:
+            friend class BroadcastRing;
+
+            Consumer(const BroadcastRing& ring, std::vector<const Sequence*> upstream) :
+                ring_(ring), upstream_(std::move(upstream)) {}
+
+            // min over the cursors this consumer is allowed to read up to
+            size_t available() const {
+                size_t min = upstream_[0]->load();
+                for (size_t i = 1; i < upstream_.size(); ++i) {
+                    min = std::min(min, upstream_[i]->load());
+                }
+                return min;
+            }
+
+            // written by this consumer, read by the producer and dependents
+            Sequence cursor_;
+            // below is only touched by the owning thread
+            const BroadcastRing& ring_;
+            std::vector<const Sequence*> upstream_;
+            size_t cached_available_ = 0;
+        };
+
+        // capacity is rounded up to a power of two
+        explicit BroadcastRing(int capacity) :
+            capacity_(round_up_pow2(capacity)),
+            mask_(capacity_ - 1),
+            store_(new T[capacity_]) {}
+
+        BroadcastRing() = delete;
+        BroadcastRing(const BroadcastRing&) = delete;
+        BroadcastRing(const BroadcastRing&&) = delete;
+        BroadcastRing& operator=(const BroadcastRing&) = delete;
+        BroadcastRing& operator=(const BroadcastRing&&) = delete;
+
+        // setup only, not thread safe. `depends_on` must be consumers of
+        // this ring; an empty list means the consumer follows the producer
+        Consumer& add_consumer(std::initializer_list<const Consumer*> depends_on = {}) {
+            std::vector<const Sequence*> upstream;
+            if (depends_on.size() == 0) {
+                upstream.push_back(&published_);
+            }
+            for (const Consumer* c : depends_on) {
+                ASSERT(&c->ring_ == this, "Consumer dependency belongs to a different BroadcastRing");
+                upstream.push_back(&c->cursor_);
+            }
+            // a consumer can never be ahead of what it depends on
+            const size_t start = published_.load();
+            consumers_.push_back(std::unique_ptr<Consumer>(new Consumer(*this, std::move(upstream))));
+            Consumer& consumer = *consumers_.back();
+            consumer.cursor_.store(start);
+            consumer.cached_available_ = start;
+            return consumer;
+        }
+
+        /*
+         * Two-phase producer API. Returns the slot for the next sequence, or
+         * nullptr if the slowest consumer is a whole lap behind. The slot
+         * still holds the element from the previous lap; overwrite it and
+         * then publish().
+        */
+        T* try_claim() {
+            if (next_ - cached_gate_ == capacity_) {
+                cached_gate_ = slowest_consumer();
+                if (next_ - cached_gate_ == capacity_) {
+                    return nullptr;
+                }
+            }
+            return &store_[next_ & mask_];
+        }
+
+        void publish() {
+            published_.store(++next_);
+        }
+
+        template <typename U>
+        bool push(U&& obj) {
+            static_assert(
+                std::is_same<T, std::decay_t<U>>::value,
+                "Type U must be the same as BroadcastRing element type T"
+            );
+            T* slot = try_claim();
+            if (slot == nullptr) {
+                return false;
+            }
+            *slot = std::forward<U>(obj);
+            publish();
+            return true;
+        }
+
+        // number of sequences published so far
+        size_t sequence() const {
+            return published_.load();
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+    private:
+        size_t slowest_consumer() const {
+            size_t min = next_;
+            for (const auto& c : consumers_) {
+                min = std::min(min, c->cursor_.load());
+            }
+            return min;
+        }
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<T[]> store_;
+        std::vector<std::unique_ptr<Consumer>> consumers_;
+
+        // read by every consumer that follows the producer
+        Sequence published_;
+        // producer-only state, on its own line after published_
+        size_t next_ = 0;
+        size_t cached_gate_ = 0;
+    };
+}
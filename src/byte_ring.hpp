@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+#include "cache_line.hpp"
+#include "macros.hpp"
+#include "pow2.hpp"
+
+namespace common {
+    /*
+     * SPSC ring of variable-length byte records, e.g. raw websocket frames.
+     *
+     * Each record is an 8-byte length header followed by the payload,
+     * padded to 8 bytes, stored contiguously. A record is never split
+     * across the end of the buffer: if it does not fit in the space left
+     * before the end, the producer writes a padding marker there and puts
+     * the record at the start, so the consumer always gets one contiguous
+     * span and the io thread hands over a frame with a single memcpy and
+     * no heap allocation.
+     *
+     * Producer: reserve(max_len) -> fill -> commit(len), or write().
+     * Consumer: peek() -> read in place -> release().
+     *
+     * Capacity is rounded up to a power of two. The largest record is
+     * max_record_size() bytes, half the capacity minus the header, which
+     * guarantees a record always fits once the consumer catches up.
+    */
+    class ByteRing {
+    private:
+        using Header = uint64_t;
+        static constexpr size_t HEADER_SIZE = sizeof(Header);
+        // header value marking the unused tail of the buffer before a wrap
+        static constexpr Header PADDING = ~Header{0};
+
+        static size_t record_size(size_t len) {
+            return (HEADER_SIZE + len + 7) & ~size_t{7};
+        }
+
+        void write_header(size_t offset, Header value) {
+            std::memcpy(&store_[offset & mask_], &value, HEADER_SIZE);
+        }
+
+        Header read_header(size_t offset) const {
+            Header value;
+            std::memcpy(&value, &store_[offset & mask_], HEADER_SIZE);
+            return value;
+        }
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<std::byte[]> store_;
+
+        // producer line: published write offset, cached read offset and the
+        // pending reservation. offsets increase monotonically
+        alignas(hardware_destructive_interference_size) std::atomic<size_t> write_idx_{};
+        size_t cached_read_idx_{};
+        size_t reserved_idx_{};
+        size_t reserved_len_{};
+        // consumer line
+        alignas(hardware_destructive_interference_size) std::atomic<size_t> read_idx_{};
+        size_t cached_write_idx_{};
+        size_t peeked_end_idx_{};
+
+    public:
+        explicit ByteRing(size_t capacity) :
+            capacity_(round_up_pow2(capacity < 2 * HEADER_SIZE ? 2 * HEADER_SIZE : capacity)),
+            mask_(capacity_ - 1),
+            store_(new std::byte[capacity_]) {}
+
+        ByteRing() = delete;
+        ByteRing(const ByteRing&) = delete;
+        ByteRing(const ByteRing&&) = delete;
+        ByteRing& operator=(const ByteRing&) = delete;
+        ByteRing& operator=(const ByteRing&&) = delete;
+
+        /*
+         * Returns `len` contiguous bytes to write a record into, or nullptr
+         * if there is not enough free space right now. Nothing is visible
+         * to the consumer until commit().
+        */
+        std::byte* reserve(size_t len) {
+            if (UNLIKELY(len > max_record_size())) {
+                FATAL("ByteRing record of " + std::to_string(len) +
+                    " bytes exceeds max_record_size() of " + std::to_string(max_record_size()));
+            }
+            const size_t write_idx = write_idx_.load(std::memory_order_relaxed);
+            const size_t need = record_size(len);
+            const size_t tail_room = capacity_ - (write_idx & mask_);
+            // wrapping burns the tail of the buffer as padding
+            const size_t required = need <= tail_room ? need : tail_room + need;
+            if (capacity_ - (write_idx - cached_read_idx_) < required) {
+                cached_read_idx_ = read_idx_.load(std::memory_order_acquire);
+                if (capacity_ - (write_idx - cached_read_idx_) < required) {
+                    return nullptr;
+                }
+            }
+            if (need > tail_room) {
+                write_header(write_idx, PADDING);
+                reserved_idx_ = write_idx + tail_room;
+            } else {
+                reserved_idx_ = write_idx;
+            }
+            reserved_len_ = len;
+            return &store_[(reserved_idx_ & mask_) + HEADER_SIZE];
+        }
+
+        // publishes the reserved record. `len` may be smaller than what
+        // was reserved, e.g. reserve for the largest frame, commit the actual
+        void commit(size_t len) {
+            if (UNLIKELY(len > reserved_len_)) {
+                FATAL("ByteRing commit of " + std::to_string(len) +
+                    " bytes exceeds reservation of " + std::to_string(reserved_len_));
+            }
+            write_header(reserved_idx_, len);
+            write_idx_.store(reserved_idx_ + record_size(len), std::memory_order_release);
+        }
+
+        // copies one record in, false if there is no room
+        bool write(const void* data, size_t len) {
+            std::byte* dst = reserve(len);
+            if (dst == nullptr) {
+                return false;
+            }
+            std::memcpy(dst, data, len);
+            commit(len);
+            return true;
+        }
+
+        /*
+         * Oldest record, or a span with a null data() if there is none (a
+         * zero-length record has a non-null data()). The bytes stay
+         * valid until release(). Calling peek() again without release()
+         * returns the same record.
+        */
+        std::span<const std::byte> peek() {
+            size_t read_idx = read_idx_.load(std::memory_order_relaxed);
+            if (read_idx == cached_write_idx_) {
+                cached_write_idx_ = write_idx_.load(std::memory_order_acquire);
+                if (read_idx == cached_write_idx_) {
+                    return {};
+                }
+            }
+            Header len = read_header(read_idx);
+            if (len == PADDING) {
+                // the producer publishes the padding and the wrapped
+                // record together, so the record is there
+                read_idx += capacity_ - (read_idx & mask_);
+                len = read_header(read_idx);
+            }
+            peeked_end_idx_ = read_idx + record_size(len);
+            return {&store_[(read_idx & mask_) + HEADER_SIZE], static_cast<size_t>(len)};
+        }
+
+        // frees the record returned by the last peek()
+        void release() {
+            read_idx_.store(peeked_end_idx_, std::memory_order_release);
+        }
+
+        // approximate while the ring is in use
+        size_t bytes_used() const {
+            const size_t read_idx = read_idx_.load(std::memory_order_acquire);
+            const size_t write_idx = write_idx_.load(std::memory_order_acquire);
+            return write_idx - read_idx;
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        size_t max_record_size() const {
+            return capacity_ / 2 - HEADER_SIZE;
+        }
+    };
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+namespace common {
+    // define cache line size
+    // std::hardware_destructive_interference_size is deliberately not used:
+    // gcc warns (-Winterference-size) that its value can change with -mtune,
+    // which would silently change the layout of every padded struct in a
+    // header. the using-declarations the queue used to have are also
+    // ill-formed at class scope, so the constants live here instead.
+
+    // 64 bytes on x86-64 │ L1_CACHE_BYTES │ L1_CACHE_SHIFT │ __cacheline_aligned │ ...
+    inline constexpr std::size_t hardware_constructive_interference_size = 64;
+    inline constexpr std::size_t hardware_destructive_interference_size = 64;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "cache_line.hpp"
+#include "lock_free_queue.hpp"
+#include "macros.hpp"
+#include "mem_pool.hpp"
+#include "page_alloc.hpp"
+
+namespace common {
+    /*
+     * MemPool that any thread may allocate from and free to, e.g. orders
+     * allocated on the feed thread and freed on the strategy thread.
+     *
+     * Free blocks form a Treiber stack. The head packs a 32-bit block
+     * index (+1, so 0 means exhausted) with a 32-bit tag that changes on
+     * every successful push and pop, so a thread that read the head, was
+     * preempted while others popped and re-pushed the same block, and then
+     * tries its CAS, fails instead of installing a stale `next` (ABA). A
+     * 64-bit head keeps the CAS a plain lock cmpxchg.
+     *
+     * Unlike MemPool the link does not share storage with the object: a
+     * popper may still read a block's link after another thread has taken
+     * the block, so the link is its own atomic word.
+     *
+     * Same allocate(args...)/deallocate(p) surface and policies as
+     * MemPool; capacity is limited to 2^32 - 1 blocks.
+    */
+    template <typename T, typename Policy = CheckedPool>
+    class ConcurrentMemPool {
+    private:
+        static_assert(
+            std::atomic<uint64_t>::is_always_lock_free,
+            "atomic uint64_t is not lock-free."
+        );
+
+        struct Block {
+            // first, so a T* is also a Block*
+            RawSlot<T> storage_;
+            // index + 1 of the next free block, 0 at the end of the list
+            std::atomic<uint32_t> next_{0};
+            std::atomic<bool> in_use_{false};
+
+            T* obj() {
+                return reinterpret_cast<T*>(storage_.bytes_);
+            }
+        };
+
+        static constexpr uint64_t INDEX_MASK = 0xffffffff;
+
+        static uint64_t pack(uint64_t tag, uint32_t index) {
+            return (tag << 32) | index;
+        }
+
+        PageBuffer pages_;
+        Block* store_;
+        const size_t capacity_;
+        // contended by every thread, keep it off the store's lines
+        alignas(hardware_destructive_interference_size) std::atomic<uint64_t> head_;
+
+    public:
+        explicit ConcurrentMemPool(int capacity, PageSize pages = PageSize::Default, int numa_node = -1) :
+            pages_(capacity * sizeof(Block), pages, alignof(Block), numa_node),
+            store_(static_cast<Block*>(pages_.data())),
+            capacity_(capacity),
+            head_(pack(0, capacity > 0 ? 1 : 0)) {
+                ASSERT(capacity_ < INDEX_MASK, "ConcurrentMemPool capacity must be below 2^32 - 1");
+                std::uninitialized_default_construct_n(store_, capacity_);
+                for (size_t i = 0; i + 1 < capacity_; ++i) {
+                    store_[i].next_.store(static_cast<uint32_t>(i + 2), std::memory_order_relaxed);
+                }
+            }
+
+        ~ConcurrentMemPool() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (size_t i = 0; i < capacity_; ++i) {
+                    if (store_[i].in_use_.load(std::memory_order_relaxed)) {
+                        std::destroy_at(store_[i].obj());
+                    }
+                }
+            }
+            std::destroy_n(store_, capacity_);
+        }
+
+        ConcurrentMemPool() = delete;
+        ConcurrentMemPool(const ConcurrentMemPool&) = delete;
+        ConcurrentMemPool(const ConcurrentMemPool&&) = delete;
+        ConcurrentMemPool& operator=(const ConcurrentMemPool&) = delete;
+        ConcurrentMemPool& operator=(const ConcurrentMemPool&&) = delete;
+
+        // safe to call from any number of threads
+        template <typename... A>
+        T* allocate(A&&... args) {
+            uint64_t head = head_.load(std::memory_order_acquire);
+            Block* block;
+            for (;;) {
+                const auto index = static_cast<uint32_t>(head & INDEX_MASK);
+                if (UNLIKELY(index == 0)) {
+                    FATAL("ConcurrentMemPool is full");
+                }
+                block = &store_[index - 1];
+                // may be stale if another thread pops this block first; the
+                // tag then makes the CAS below fail
+                const uint32_t next = block->next_.load(std::memory_order_relaxed);
+                if (head_.compare_exchange_weak(head, pack((head >> 32) + 1, next),
+                        std::memory_order_acquire, std::memory_order_acquire)) {
+                    break;
+                }
+            }
+            T* new_obj = new (block->obj()) T(std::forward<A>(args)...);
+            block->in_use_.store(true, std::memory_order_relaxed);
+            if constexpr (Policy::traced) {
+                std::cout << "Successfully allocated at index " << block - store_ << std::endl;
+            }
+            return new_obj;
+        }
+
+        // safe to call from any number of threads, not only the allocating one
+        void deallocate(const T* obj) {
+            const auto dealloc_idx = reinterpret_cast<const Block*>(obj) - store_;
+            if constexpr (Policy::checked) {
+                if (UNLIKELY(dealloc_idx < 0 || static_cast<size_t>(dealloc_idx) >= capacity_)) {
+                    FATAL("Element being deallocated does not belong to this ConcurrentMemPool.");
+                }
+            }
+            Block* block = &store_[dealloc_idx];
+            if constexpr (Policy::checked) {
+                // an RMW, so of two racing frees of one block only one wins
+                if (UNLIKELY(!block->in_use_.exchange(false, std::memory_order_relaxed))) {
+                    FATAL("Expected in-use block at index: " + std::to_string(dealloc_idx));
+                }
+            } else {
+                // still kept for the destructor, but no locked instruction
+                block->in_use_.store(false, std::memory_order_relaxed);
+            }
+            std::destroy_at(block->obj());
+            const auto index = static_cast<uint32_t>(dealloc_idx + 1);
+            uint64_t head = head_.load(std::memory_order_relaxed);
+            do {
+                block->next_.store(static_cast<uint32_t>(head & INDEX_MASK), std::memory_order_relaxed);
+            } while (!head_.compare_exchange_weak(head, pack((head >> 32) + 1, index),
+                        std::memory_order_release, std::memory_order_relaxed));
+            if constexpr (Policy::traced) {
+                std::cout << "Successfully deallocated at index " << dealloc_idx << std::endl;
+            }
+        }
+
+        // true if `obj` points into this pool's store
+        bool owns(const T* obj) const {
+            const auto idx = reinterpret_cast<const Block*>(obj) - store_;
+            return idx >= 0 && static_cast<size_t>(idx) < capacity_;
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include "lock_free_queue.hpp"
+
+namespace common {
+    /*
+     * SPSC channel with two lanes: a small high-priority lane for control
+     * messages (cancel all, risk halt, kill switch) and a bulk lane for
+     * market data. The consumer always looks at the high lane first, so a
+     * control message never waits behind a level2 burst; within each lane
+     * order is FIFO. There is no ordering between the lanes.
+     *
+     * Each lane is its own LFQueue with its own cursors, so the guarantees
+     * are LFQueue's: wait-free push and pop, one producer thread, one
+     * consumer thread. A full bulk lane never blocks the high lane.
+     *
+     * drain() re-checks the high lane before every `BulkChunk` bulk
+     * elements, which bounds how long a control message can sit behind
+     * work that was already handed to the consumer.
+    */
+    template <typename T, size_t BulkChunk = 16>
+    class DualLaneQueue {
+    public:
+        static_assert(BulkChunk > 0, "BulkChunk must be at least 1.");
+
+        DualLaneQueue(int high_capacity, int bulk_capacity) :
+            high_(high_capacity),
+            bulk_(bulk_capacity) {}
+
+        DualLaneQueue() = delete;
+        DualLaneQueue(const DualLaneQueue&) = delete;
+        DualLaneQueue(const DualLaneQueue&&) = delete;
+        DualLaneQueue& operator=(const DualLaneQueue&) = delete;
+        DualLaneQueue& operator=(const DualLaneQueue&&) = delete;
+
+        // producer side. false if the lane is full
+        template <typename U>
+        bool push_high(U&& obj) {
+            return high_.push(std::forward<U>(obj));
+        }
+
+        template <typename U>
+        bool push(U&& obj) {
+            return bulk_.push(std::forward<U>(obj));
+        }
+
+        // consumer side: oldest high-priority element if there is one,
+        // otherwise the oldest bulk element
+        std::optional<T> pop() {
+            std::optional<T> out = high_.pop();
+            if (out.has_value()) {
+                return out;
+            }
+            return bulk_.pop();
+        }
+
+        /*
+         * Calls `callback(T&)` on up to `max` elements, high lane first,
+         * same contract as LFQueue::drain(). Bulk elements are taken in
+         * chunks of at most `BulkChunk` with the high lane checked in
+         * between.
+        */
+        template <typename F>
+        size_t drain(F&& callback, size_t max) {
+            size_t total = 0;
+            while (total < max) {
+                if (!high_.empty()) {
+                    total += high_.drain(callback, max - total);
+                    continue;
+                }
+                const size_t n = bulk_.drain(callback, std::min(BulkChunk, max - total));
+                if (n == 0) {
+                    break;
+                }
+                total += n;
+            }
+            return total;
+        }
+
+        bool empty() const {
+            return high_.empty() && bulk_.empty();
+        }
+
+        // control messages are rare, the bulk lane is what a poller
+        // wants in cache
+        void prefetch_next() const {
+            bulk_.prefetch_next();
+        }
+
+        // approximate while the queue is in use, see LFQueue::size()
+        size_t size() const {
+            return high_.size() + bulk_.size();
+        }
+
+        size_t high_size() const {
+            return high_.size();
+        }
+
+        size_t bulk_size() const {
+            return bulk_.size();
+        }
+
+    private:
+        LFQueue<T> high_;
+        LFQueue<T> bulk_;
+    };
+}
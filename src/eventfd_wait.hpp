@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "cache_line.hpp"
+#include "macros.hpp"
+
+namespace common {
+    /*
+     * Wait policy (see wait_strategy.hpp) backed by an eventfd, so that a
+     * consumer can sleep in an event loop (epoll, asio) instead of on a
+     * futex.
+     *
+     * The consumer arms the notifier when it finds the queue empty and
+     * re-checks the queue before going to sleep. notify() writes the
+     * eventfd only if the consumer is armed, and disarms it in the same
+     * step, so a burst of pushes after an empty queue costs exactly one
+     * syscall, and pushes while the consumer is busy cost none.
+    */
+    class EventFdWait {
+    public:
+        EventFdWait() : fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+            if (fd_ == -1) {
+                FATAL(std::string("eventfd failed: ") + std::strerror(errno));
+            }
+        }
+
+        ~EventFdWait() {
+            close(fd_);
+        }
+
+        EventFdWait(const EventFdWait&) = delete;
+        EventFdWait(const EventFdWait&&) = delete;
+        EventFdWait& operator=(const EventFdWait&) = delete;
+        EventFdWait& operator=(const EventFdWait&&) = delete;
+
+        // readable once notify() signalled an armed consumer
+        int fd() const {
+            return fd_;
+        }
+
+        /*
+         * Consumer side, for event loops:
+         *   arm(); if the queue is still empty, wait for fd() to become
+         *   readable, then clear() and drain; otherwise disarm() and drain.
+        */
+        void arm() {
+            // an RMW, paired with the one in notify(): either the consumer's
+            // re-check sees the element, or the producer sees the flag
+            armed_.exchange(1, std::memory_order_seq_cst);
+        }
+
+        void disarm() {
+            armed_.store(0, std::memory_order_relaxed);
+        }
+
+        // resets the eventfd counter after a wake-up
+        void clear() {
+            uint64_t count;
+            while (read(fd_, &count, sizeof(count)) == -1 && errno == EINTR);
+        }
+
+        // blocking wait for threads that are not running an event loop
+        template <typename F>
+        void wait(F&& ready) {
+            for (;;) {
+                if (ready()) {
+                    return;
+                }
+                arm();
+                if (ready()) {
+                    disarm();
+                    return;
+                }
+                pollfd pfd{fd_, POLLIN, 0};
+                while (poll(&pfd, 1, -1) == -1 && errno == EINTR);
+                clear();
+            }
+        }
+
+        void notify() {
+            // an RMW rather than a load, so it cannot be reordered before
+            // the caller's push; clearing the flag also means only one
+            // notify() writes the eventfd per arm()
+            if (armed_.exchange(0, std::memory_order_seq_cst) != 0) {
+                const uint64_t one = 1;
+                while (write(fd_, &one, sizeof(one)) == -1 && errno == EINTR);
+                signals_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // number of times notify() actually wrote the eventfd
+        uint64_t signals() const {
+            return signals_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        int fd_;
+        // written by the consumer when it is about to sleep, read by the
+        // producer on every notify()
+        alignas(hardware_destructive_interference_size) std::atomic<uint32_t> armed_{0};
+        std::atomic<uint64_t> signals_{0};
+    };
+}
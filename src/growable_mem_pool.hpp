@@ -0,0 +1,265 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "macros.hpp"
+#include "mem_pool.hpp"
+#include "page_alloc.hpp"
+#include "pow2.hpp"
+#include "thread_utils.hpp"
+
+namespace common {
+    /*
+     * MemPool that grows instead of FATAL-ing when it runs out, for pools
+     * whose peak (e.g. live orders on a volatile day) can be many times
+     * the usual load.
+     *
+     * Storage is a table of up to `max_slabs` fixed-size slabs of
+     * `slab_capacity` blocks. Existing slabs are never moved or freed while
+     * the pool lives, so pointers stay stable across growth, and the table
+     * is sized up front so growing never reallocates it. Free blocks of all
+     * slabs share one PoolFreeList, as in MemPool, so allocate() and
+     * deallocate() stay O(1).
+     *
+     * Building a slab means mapping it and touching every page to thread
+     * the free list through it, which is far too slow for the hot path.
+     * A background pre-allocator thread therefore keeps one spare slab
+     * fully built; when the free list runs dry the owning thread just
+     * splices the spare in and wakes the pre-allocator to build the next.
+     * Only if a burst outruns the pre-allocator does the owning thread
+     * build a slab itself; sync_grows() counts those.
+     *
+     * CheckedPool catches double frees and foreign pointers, as in
+     * MemPool. Slabs sit wherever their pages were mapped, so each one is
+     * filed in a fixed open-addressing table under the one or two
+     * power-of-two address spans it covers; the ownership check hashes the
+     * pointer's span and range-checks the slabs filed there, which is O(1)
+     * and never reads the pointer's memory.
+     *
+     * Like MemPool, one thread allocates and frees. The pre-allocator
+     * can be pinned to a housekeeping core with `prealloc_core`; pass the
+     * owning thread's node as `numa_node` so slabs it touches are still
+     * local to the owner.
+    */
+    template <typename T, typename Policy = CheckedPool>
+    class GrowableMemPool {
+    private:
+        using FreeList = PoolFreeList<T, Policy>;
+        using ObjectBlock = typename FreeList::Block;
+
+        struct Slab {
+            Slab(size_t capacity, PageSize pages, int numa_node) :
+                pages_(capacity * sizeof(ObjectBlock), pages, alignof(ObjectBlock), numa_node),
+                blocks_(static_cast<ObjectBlock*>(pages_.data())),
+                first_free_(FreeList::link_blocks(blocks_, capacity)) {}
+
+            PageBuffer pages_;
+            ObjectBlock* blocks_;
+            ObjectBlock* first_free_;
+        };
+
+        // an entry per (address span, slab) pair, see index_slab()
+        struct SpanEntry {
+            uintptr_t span_;
+            const Slab* slab_;
+        };
+
+        static void prealloc_loop(GrowableMemPool& pool) {
+            for (;;) {
+                Slab* spare = pool.spare_.load(std::memory_order_acquire);
+                if (pool.stop_.load(std::memory_order_acquire)) {
+                    return;
+                }
+                if (spare != nullptr) {
+                    // sleep until the owner takes it
+                    pool.spare_.wait(spare, std::memory_order_acquire);
+                    continue;
+                }
+                pool.spare_.store(pool.make_slab(), std::memory_order_release);
+            }
+        }
+
+        Slab* make_slab() const {
+            return new Slab(slab_capacity_, pages_, numa_node_);
+        }
+
+        void grow() {
+            if (UNLIKELY(slabs_.size() == max_slabs_)) {
+                FATAL("GrowableMemPool reached its " + std::to_string(max_slabs_) + " slabs");
+            }
+            Slab* slab = spare_.exchange(nullptr, std::memory_order_acq_rel);
+            if (LIKELY(slab != nullptr)) {
+                spare_.notify_one();
+            } else {
+                slab = make_slab();
+                ++sync_grows_;
+            }
+            // within the reserved capacity: never reallocates
+            slabs_.emplace_back(slab);
+            index_slab(slab);
+            free_list_.splice(slab->first_free_);
+            ++slab_grows_;
+        }
+
+        size_t span_slot(uintptr_t span) const {
+            return static_cast<size_t>((span * 0x9E3779B97F4A7C15ull) >> span_hash_shift_);
+        }
+
+        // a slab is shorter than a span, so it covers at most two of them
+        void index_slab(const Slab* slab) {
+            const auto begin = reinterpret_cast<uintptr_t>(slab->blocks_);
+            const uintptr_t first = begin >> span_shift_;
+            const uintptr_t last = (begin + slab_bytes_ - 1) >> span_shift_;
+            for (uintptr_t span = first; span <= last; ++span) {
+                size_t i = span_slot(span);
+                while (span_table_[i].slab_ != nullptr) {
+                    i = (i + 1) & (span_table_.size() - 1);
+                }
+                span_table_[i] = SpanEntry{span, slab};
+            }
+        }
+
+        const size_t slab_capacity_;
+        const size_t slab_bytes_;
+        const size_t max_slabs_;
+        const PageSize pages_;
+        const int numa_node_;
+        std::vector<std::unique_ptr<Slab>> slabs_;
+        // two entries per slab at most, kept at most half full
+        const int span_shift_;
+        const int span_hash_shift_;
+        std::vector<SpanEntry> span_table_;
+        FreeList free_list_;
+        size_t slab_grows_ = 0;
+        size_t sync_grows_ = 0;
+
+        // shared with the pre-allocator
+        alignas(hardware_destructive_interference_size) std::atomic<Slab*> spare_{nullptr};
+        std::atomic<bool> stop_{false};
+        std::unique_ptr<std::thread> prealloc_thread_;
+
+    public:
+        explicit GrowableMemPool(int slab_capacity, int max_slabs = 1024, PageSize pages = PageSize::Default,
+                                 int numa_node = -1, int prealloc_core = -1) :
+            slab_capacity_(slab_capacity),
+            slab_bytes_(slab_capacity_ * sizeof(ObjectBlock)),
+            max_slabs_(max_slabs),
+            pages_(pages),
+            numa_node_(numa_node),
+            span_shift_(std::countr_zero(round_up_pow2(slab_bytes_))),
+            span_hash_shift_(64 - std::countr_zero(round_up_pow2(4 * max_slabs_))),
+            span_table_(round_up_pow2(4 * max_slabs_), SpanEntry{0, nullptr}) {
+                ASSERT(slab_capacity > 0 && max_slabs > 0, "GrowableMemPool needs at least one non-empty slab");
+                slabs_.reserve(max_slabs_);
+                slabs_.emplace_back(make_slab());
+                index_slab(slabs_.back().get());
+                free_list_.splice(slabs_.back()->first_free_);
+                // quiet: pools are built often, e.g. once per benchmark run
+                prealloc_thread_.reset(create_and_start_thread(
+                    ThreadLog::Quiet, prealloc_core, "mem_pool_prealloc", prealloc_loop, *this
+                ));
+            }
+
+        ~GrowableMemPool() {
+            stop_.store(true, std::memory_order_release);
+            // changing the value wakes the pre-allocator if it sleeps
+            delete spare_.exchange(nullptr, std::memory_order_acq_rel);
+            spare_.notify_one();
+            prealloc_thread_->join();
+            // it may have finished one more slab before seeing stop_
+            delete spare_.load(std::memory_order_acquire);
+
+            for (auto& slab : slabs_) {
+                FreeList::destroy_blocks(slab->blocks_, slab_capacity_);
+            }
+        }
+
+        GrowableMemPool() = delete;
+        GrowableMemPool(const GrowableMemPool&) = delete;
+        GrowableMemPool(const GrowableMemPool&&) = delete;
+        GrowableMemPool& operator=(const GrowableMemPool&) = delete;
+        GrowableMemPool& operator=(const GrowableMemPool&&) = delete;
+
+        // grows by a slab when every block is in use; fails only once
+        // `max_slabs` slabs are full
+        template <typename... A>
+        T* allocate(A&&... args) {
+            if (UNLIKELY(free_list_.empty())) {
+                grow();
+            }
+            T* new_obj = free_list_.allocate(std::forward<A>(args)...);
+            if constexpr (Policy::traced) {
+                std::cout << "Successfully allocated " << new_obj << ". New size = " << size() << std::endl;
+            }
+            return new_obj;
+        }
+
+        void deallocate(const T* obj) {
+            if constexpr (Policy::checked) {
+                if (UNLIKELY(!owns(obj))) {
+                    FATAL("Element being deallocated does not belong to this GrowableMemPool.");
+                }
+            }
+            free_list_.deallocate(reinterpret_cast<ObjectBlock*>(const_cast<T*>(obj)));
+            if constexpr (Policy::traced) {
+                std::cout << "Successfully deallocated " << obj << ". New size = " << size() << std::endl;
+            }
+        }
+
+        // true if `obj` points at a block of one of the slabs; O(1)
+        bool owns(const T* obj) const {
+            const auto addr = reinterpret_cast<uintptr_t>(obj);
+            const uintptr_t span = addr >> span_shift_;
+            for (size_t i = span_slot(span); span_table_[i].slab_ != nullptr; i = (i + 1) & (span_table_.size() - 1)) {
+                if (span_table_[i].span_ != span) {
+                    continue;
+                }
+                const auto begin = reinterpret_cast<uintptr_t>(span_table_[i].slab_->blocks_);
+                if (addr >= begin && addr < begin + slab_bytes_) {
+                    return (addr - begin) % sizeof(ObjectBlock) == 0;
+                }
+            }
+            return false;
+        }
+
+        // number of live objects
+        size_t size() const {
+            return free_list_.size();
+        }
+
+        size_t capacity() const {
+            return slabs_.size() * slab_capacity_;
+        }
+
+        size_t slabs() const {
+            return slabs_.size();
+        }
+
+        size_t max_slabs() const {
+            return max_slabs_;
+        }
+
+        // slabs added since construction, and how many of those the
+        // owning thread had to build itself because no spare was ready
+        size_t slab_grows() const {
+            return slab_grows_;
+        }
+
+        size_t sync_grows() const {
+            return sync_grows_;
+        }
+
+        // whether the next grow is a cheap splice
+        bool spare_ready() const {
+            return spare_.load(std::memory_order_acquire) != nullptr;
+        }
+    };
+}
@@ -1,12 +1,35 @@
 #pragma once
 
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
 #include <atomic>
 #include <optional>
 #include <new>
 
+#include "cache_line.hpp"
+#include "page_alloc.hpp"
+#include "pow2.hpp"
+
 namespace common {
+    // uninitialized storage for one T. elements are constructed in place 
+    // on push and destroyed on pop, so T does not need a default 
+    // constructor and an unused slot is never touched
     template <typename T>
+    struct alignas(T) RawSlot {
+        std::byte bytes_[sizeof(T)];
+    };
+
+    /*
+     * `ExactSize` keeps a shared element counter up to date on every push 
+     * and pop so that `size()` is exact. That is a locked RMW on a line 
+     * both threads write, so it is meant for tests only; by default 
+     * `size()` is derived from the two cursors instead.
+    */
+    template <typename T, bool ExactSize = false>
     class LFQueue {
     private:
 
@@ -16,18 +39,11 @@ namespace common {
             "atomic size_t is not lock-free."
         );
 
-        // define cache line size
-        #ifdef __cpp_lib_hardware_interference_size
-            using std::hardware_constructive_interference_size;
-            using std::hardware_destructive_interference_size;
-        #else
-            // 64 bytes on x86-64 │ L1_CACHE_BYTES │ L1_CACHE_SHIFT │ __cacheline_aligned │ ...
-            static constexpr std::size_t hardware_constructive_interference_size = 64;
-            static constexpr std::size_t hardware_destructive_interference_size = 64;
-        #endif
-
         size_t capacity_;
-        std::vector<T> store_;
+        // left uninitialized: a large ring costs nothing until its pages 
+        // are first written. optionally on huge pages, see PageBuffer
+        PageBuffer pages_;
+        RawSlot<T>* store_;
         // avoid false sharing, which leads to waiting, by aligning different 
         // thread work on different cache lines when using atomics
         // on NUMA machines may even need to align to different pages
@@ -38,8 +54,14 @@ namespace common {
         // aligning the idx to the size of the cache line prevents false sharing.
         alignas(hardware_destructive_interference_size) std::atomic<size_t> cur_write_idx_{};
         alignas(hardware_destructive_interference_size) std::atomic<size_t> cur_read_idx_{};
-        alignas(hardware_destructive_interference_size) std::atomic<size_t> size_{};
-        // TODO: put read_idx and write_idx on separate cache lines, then evaluate perf
+        // only exists when ExactSize is set. each side counts its elements 
+        // in before publishing its cursor, so anyone who can see an element 
+        // also sees it counted and the counter never drops below zero
+        struct alignas(hardware_destructive_interference_size) ExactCounter {
+            std::atomic<size_t> value_{};
+        };
+        struct NoCounter {};
+        [[no_unique_address]] std::conditional_t<ExactSize, ExactCounter, NoCounter> size_;
         // should capacity be aligned too?
 
         // not sure if this is also necessary for false sharing but saw in cppcon23
@@ -47,14 +69,57 @@ namespace common {
         // char padding_[hardware_destructive_interference_size - sizeof(size_t)];
 
 
-        size_t increment(size_t idx) {
+        size_t increment(size_t idx) const {
             return (idx + 1) % capacity_;
         }
 
+        T* slot(size_t idx) const {
+            return reinterpret_cast<T*>(store_[idx].bytes_);
+        }
+
+        // contiguous copies for the batched operations. `dst` is raw 
+        // storage on push_n, and the source elements are destroyed on pop_n
+        static void copy_n(const T* src, size_t n, T* dst) {
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                if (n > 0) {
+                    std::memcpy(dst, src, n * sizeof(T));
+                }
+            } else {
+                std::uninitialized_copy_n(src, n, dst);
+            }
+        }
+
+        static void move_n(T* src, size_t n, T* dst) {
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                if (n > 0) {
+                    std::memcpy(dst, src, n * sizeof(T));
+                }
+            } else {
+                std::move(src, src + n, dst);
+                std::destroy_n(src, n);
+            }
+        }
+
     public:
         // init to the provided capacity+1 because of the way push and 
-        // pop check if the buffer is empty/full
-        LFQueue(int capacity) : capacity_(capacity+1), store_(capacity+1) {}
+        // pop check if the buffer is empty/full. pass PageSize::Huge2M or 
+        // Huge1G for large rings to cut dTLB misses, and the consumer's 
+        // node as `numa_node` to keep the ring local to it
+        LFQueue(int capacity, PageSize pages = PageSize::Default, int numa_node = -1) : 
+            capacity_(capacity+1), 
+            pages_((capacity+1) * sizeof(RawSlot<T>), pages, alignof(RawSlot<T>), numa_node),
+            store_(static_cast<RawSlot<T>*>(pages_.data())) {}
+
+        ~LFQueue() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                size_t read_idx = cur_read_idx_.load(std::memory_order_acquire);
+                const size_t write_idx = cur_write_idx_.load(std::memory_order_acquire);
+                while (read_idx != write_idx) {
+                    read_idx = increment(read_idx);
+                    std::destroy_at(slot(read_idx));
+                }
+            }
+        }
 
         LFQueue() = delete;
         LFQueue(const LFQueue&) = delete;
@@ -97,14 +162,14 @@ namespace common {
             if (write_idx == cur_read_idx_.load(std::memory_order_acquire)) {
                 return false;
             }
-            store_[write_idx] = std::forward<U>(obj);
+            new (slot(write_idx)) T(std::forward<U>(obj));
+            if constexpr (ExactSize) {
+                size_.value_.fetch_add(1, std::memory_order_acq_rel);
+            }
             cur_write_idx_.store(write_idx, std::memory_order_release);
-            // size_.fetch_add(1, std::memory_order_relaxed);
-            size_.fetch_add(1);
             return true;
         }
-        // TODO: test a split version of this that returns pointer,
-        // where other function updates the idx. leaves more for the user to do but could be faster
+        // see peek()/consume() for a version that reads the slot in place
         std::optional<T> pop() { 
             size_t read_idx = cur_read_idx_.load(std::memory_order_relaxed);
             // fail if the buffer is empty
@@ -112,16 +177,339 @@ namespace common {
                 return std::nullopt;
             }
             read_idx = increment(read_idx);
-            T out = std::move(store_[read_idx]);
+            std::optional<T> out(std::move(*slot(read_idx)));
+            std::destroy_at(slot(read_idx));
+            if constexpr (ExactSize) {
+                size_.value_.fetch_sub(1, std::memory_order_acq_rel);
+            }
             cur_read_idx_.store(read_idx, std::memory_order_release);
-            // size_.fetch_sub(1, std::memory_order_relaxed);
-            size_.fetch_sub(1);
             return out;
         }
 
-        size_t size() {
-            return size_.load(); // default sequential consistency
+        /*
+         * Two-phase producer API. Returns the next free slot, or nullptr if 
+         * the queue is full. The producer fills the slot in place and then
+         * publishes it with commit_write(); nothing is visible to the 
+         * consumer until then. Each successful get_next_to_write() must be 
+         * followed by exactly one commit_write() before the next call.
+         *
+         * The slot is uninitialized storage. Trivially copyable types can 
+         * be written field by field; anything else must be constructed 
+         * with placement new before commit_write().
+        */
+        T* get_next_to_write() {
+            const size_t write_idx = increment(cur_write_idx_.load(std::memory_order_relaxed));
+            if (write_idx == cur_read_idx_.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            return slot(write_idx);
+        }
+
+        void commit_write() {
+            const size_t write_idx = increment(cur_write_idx_.load(std::memory_order_relaxed));
+            if constexpr (ExactSize) {
+                size_.value_.fetch_add(1, std::memory_order_acq_rel);
+            }
+            cur_write_idx_.store(write_idx, std::memory_order_release);
+        }
+
+        /*
+         * Two-phase consumer API. Returns the oldest element, or nullptr if 
+         * the queue is empty. The element stays valid, and is not 
+         * overwritten by the producer, until consume() destroys it and 
+         * releases the slot.
+        */
+        const T* peek() const {
+            const size_t read_idx = cur_read_idx_.load(std::memory_order_relaxed);
+            if (read_idx == cur_write_idx_.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            return slot(increment(read_idx));
+        }
+
+        void consume() {
+            const size_t read_idx = increment(cur_read_idx_.load(std::memory_order_relaxed));
+            std::destroy_at(slot(read_idx));
+            if constexpr (ExactSize) {
+                size_.value_.fetch_sub(1, std::memory_order_acq_rel);
+            }
+            cur_read_idx_.store(read_idx, std::memory_order_release);
+        }
+
+        /*
+         * Batched operations: move up to `n` elements with a single cursor 
+         * publish, so a burst pays for one release-store instead of one per
+         * element. The copy is split in two when the batch wraps past the 
+         * end of the ring. All return the number of elements moved, which 
+         * may be less than requested (including 0).
+        */
+        size_t push_n(const T* src, size_t n) {
+            const size_t write_idx = cur_write_idx_.load(std::memory_order_relaxed);
+            const size_t read_idx = cur_read_idx_.load(std::memory_order_acquire);
+            // one slot is always kept empty to tell full from empty
+            const size_t free_slots = capacity_ - 1 - (write_idx + capacity_ - read_idx) % capacity_;
+            const size_t count = std::min(n, free_slots);
+            if (count == 0) {
+                return 0;
+            }
+            const size_t first = increment(write_idx);
+            const size_t head = std::min(count, capacity_ - first);
+            copy_n(src, head, slot(first));
+            copy_n(src + head, count - head, slot(0));
+            if constexpr (ExactSize) {
+                size_.value_.fetch_add(count, std::memory_order_acq_rel);
+            }
+            cur_write_idx_.store((write_idx + count) % capacity_, std::memory_order_release);
+            return count;
+        }
+
+        size_t pop_n(T* dst, size_t n) {
+            const size_t read_idx = cur_read_idx_.load(std::memory_order_relaxed);
+            const size_t write_idx = cur_write_idx_.load(std::memory_order_acquire);
+            const size_t count = std::min(n, (write_idx + capacity_ - read_idx) % capacity_);
+            if (count == 0) {
+                return 0;
+            }
+            const size_t first = increment(read_idx);
+            const size_t head = std::min(count, capacity_ - first);
+            move_n(slot(first), head, dst);
+            move_n(slot(0), count - head, dst + head);
+            if constexpr (ExactSize) {
+                size_.value_.fetch_sub(count, std::memory_order_acq_rel);
+            }
+            cur_read_idx_.store((read_idx + count) % capacity_, std::memory_order_release);
+            return count;
+        }
+
+        // calls `callback(T&)` on up to `max` elements in FIFO order, then 
+        // releases all of them at once. the callback may move from the 
+        // element; it is destroyed right after the callback returns. if the 
+        // callback throws, the elements it already finished are still 
+        // released and the one it threw on stays at the front of the queue
+        template <typename F>
+        size_t drain(F&& callback, size_t max) {
+            const size_t read_idx = cur_read_idx_.load(std::memory_order_relaxed);
+            const size_t write_idx = cur_write_idx_.load(std::memory_order_acquire);
+            const size_t count = std::min(max, (write_idx + capacity_ - read_idx) % capacity_);
+
+            // publishes however far the loop got, also when unwinding
+            struct Release {
+                LFQueue& queue_;
+                size_t idx_;
+                size_t done_ = 0;
+
+                ~Release() {
+                    if (done_ > 0) {
+                        if constexpr (ExactSize) {
+                            queue_.size_.value_.fetch_sub(done_, std::memory_order_acq_rel);
+                        }
+                        queue_.cur_read_idx_.store(idx_, std::memory_order_release);
+                    }
+                }
+            } release{*this, read_idx};
+
+            while (release.done_ < count) {
+                const size_t idx = increment(release.idx_);
+                callback(*slot(idx));
+                std::destroy_at(slot(idx));
+                release.idx_ = idx;
+                ++release.done_;
+            }
+            return count;
+        }
+
+        // consumer side: cheaper than size() when only emptiness matters
+        bool empty() const {
+            return cur_read_idx_.load(std::memory_order_relaxed) == 
+                cur_write_idx_.load(std::memory_order_acquire);
+        }
+
+        // consumer side: pull the next slot to be read into cache, e.g. 
+        // while still busy with another queue. only a hint, never faults
+        void prefetch_next() const {
+            __builtin_prefetch(slot(increment(cur_read_idx_.load(std::memory_order_relaxed))));
+        }
+
+        // safe to call from any thread. without ExactSize the result is 
+        // approximate while the queue is in use. the cursors wrap at 
+        // capacity, so a read cursor gone stale while the write cursor 
+        // moved on would wrap the difference into a meaningless count; 
+        // the read cursor is therefore re-loaded until it did not move 
+        // around the write cursor load, which makes the result a count the 
+        // queue really held during the call. only a consumer lapping the 
+        // whole ring between two loads can still fool it
+        size_t size() const {
+            if constexpr (ExactSize) {
+                return size_.value_.load(std::memory_order_acquire);
+            } else {
+                size_t read_idx = cur_read_idx_.load(std::memory_order_acquire);
+                for (;;) {
+                    const size_t write_idx = cur_write_idx_.load(std::memory_order_acquire);
+                    const size_t again = cur_read_idx_.load(std::memory_order_acquire);
+                    if (again == read_idx) {
+                        return (write_idx + capacity_ - read_idx) % capacity_;
+                    }
+                    read_idx = again;
+                }
+            }
+        }
+
+        // which pages actually back the ring
+        PageKind page_kind() const {
+            return pages_.obtained();
+        }
+
+        // without an explicit node: call from the pinned consumer thread 
+        // before first use, so the ring is allocated on its node
+        void first_touch() {
+            pages_.first_touch();
+        }
+
+        // node the ring lives on, -1 if unknown or never touched
+        int numa_node() const {
+            return pages_.numa_node();
+        }
+
+    };
+
+    /*
+     * SPSC ring with a compile-time, power-of-two capacity `N`.
+     *
+     * Same push/pop surface as LFQueue, but built for the hottest hop
+     * in the pipeline:
+     *   - storage is inline, so there is no pointer chase to reach a slot
+     *   - cursors increase monotonically and are wrapped with `& MASK`
+     *     instead of an integer divide
+     *   - each side keeps a private copy of the other side's cursor and
+     *     only reloads the shared atomic when the ring looks full (producer)
+     *     or empty (consumer), so in steady state a push or pop touches
+     *     just its own cache line plus the slot
+     *
+     * The object is sizeof(T) * N bytes, so large rings should live on
+     * the heap (e.g. std::make_unique) rather than on a thread's stack.
+    */
+    template <typename T, size_t N>
+    class FixedLFQueue {
+    private:
+        static_assert(
+            is_pow2(N),
+            "FixedLFQueue capacity must be a power of two."
+        );
+        static_assert(
+            std::atomic<size_t>::is_always_lock_free, 
+            "atomic size_t is not lock-free."
+        );
+
+        static constexpr size_t MASK = N - 1;
+
+        // producer-owned line: the published write cursor and the 
+        // producer's last observed value of the read cursor
+        alignas(hardware_destructive_interference_size) std::atomic<size_t> write_idx_{};
+        size_t cached_read_idx_{};
+        // consumer-owned line, mirror image of the above
+        alignas(hardware_destructive_interference_size) std::atomic<size_t> read_idx_{};
+        size_t cached_write_idx_{};
+        // keep slot 0 off the consumer's line
+        alignas(hardware_destructive_interference_size) std::array<RawSlot<T>, N> store_;
+
+        T* slot(size_t idx) {
+            return reinterpret_cast<T*>(store_[idx & MASK].bytes_);
+        }
+
+    public:
+        FixedLFQueue() = default;
+        ~FixedLFQueue() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                const size_t write_idx = write_idx_.load(std::memory_order_acquire);
+                for (size_t i = read_idx_.load(std::memory_order_acquire); i != write_idx; ++i) {
+                    std::destroy_at(slot(i));
+                }
+            }
+        }
+        FixedLFQueue(const FixedLFQueue&) = delete;
+        FixedLFQueue(const FixedLFQueue&&) = delete;
+        FixedLFQueue& operator=(const FixedLFQueue&) = delete;
+        FixedLFQueue& operator=(const FixedLFQueue&&) = delete;
+
+        template <typename U>
+        bool push(U&& obj) {
+            static_assert(
+                std::is_same<T, std::decay_t<U>>::value, 
+                "Type U must be the same as FixedLFQueue element type T"
+            );
+            const size_t write_idx = write_idx_.load(std::memory_order_relaxed);
+            // only go to the shared read cursor when the ring looks full
+            if (write_idx - cached_read_idx_ == N) {
+                cached_read_idx_ = read_idx_.load(std::memory_order_acquire);
+                if (write_idx - cached_read_idx_ == N) {
+                    return false;
+                }
+            }
+            new (slot(write_idx)) T(std::forward<U>(obj));
+            write_idx_.store(write_idx + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::optional<T> pop() {
+            const size_t read_idx = read_idx_.load(std::memory_order_relaxed);
+            // only go to the shared write cursor when the ring looks empty
+            if (read_idx == cached_write_idx_) {
+                cached_write_idx_ = write_idx_.load(std::memory_order_acquire);
+                if (read_idx == cached_write_idx_) {
+                    return std::nullopt;
+                }
+            }
+            std::optional<T> out(std::move(*slot(read_idx)));
+            std::destroy_at(slot(read_idx));
+            read_idx_.store(read_idx + 1, std::memory_order_release);
+            return out;
+        }
+
+        // two-phase API, same contract as LFQueue's
+        T* get_next_to_write() {
+            const size_t write_idx = write_idx_.load(std::memory_order_relaxed);
+            if (write_idx - cached_read_idx_ == N) {
+                cached_read_idx_ = read_idx_.load(std::memory_order_acquire);
+                if (write_idx - cached_read_idx_ == N) {
+                    return nullptr;
+                }
+            }
+            return slot(write_idx);
+        }
+
+        void commit_write() {
+            write_idx_.store(write_idx_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // not const: refreshes the consumer's cached copy of the write cursor
+        const T* peek() {
+            const size_t read_idx = read_idx_.load(std::memory_order_relaxed);
+            if (read_idx == cached_write_idx_) {
+                cached_write_idx_ = write_idx_.load(std::memory_order_acquire);
+                if (read_idx == cached_write_idx_) {
+                    return nullptr;
+                }
+            }
+            return slot(read_idx);
+        }
+
+        void consume() {
+            const size_t read_idx = read_idx_.load(std::memory_order_relaxed);
+            std::destroy_at(slot(read_idx));
+            read_idx_.store(read_idx + 1, std::memory_order_release);
         }
 
+        // approximate when called while the other side is running.
+        // read cursor is loaded first so that write_idx >= read_idx
+        size_t size() const {
+            const size_t read_idx = read_idx_.load(std::memory_order_acquire);
+            const size_t write_idx = write_idx_.load(std::memory_order_acquire);
+            const size_t n = write_idx - read_idx;
+            return n < N ? n : N;
+        }
+
+        static constexpr size_t capacity() {
+            return N;
+        }
     };
 }
\ No newline at end of file
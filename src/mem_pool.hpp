@@ -1,22 +1,159 @@
 #pragma once
 
-#include <vector>
 #include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
 
 #include "macros.hpp"
+#include "page_alloc.hpp"
 
 namespace common {
-    template <typename T>
+    /*
+     * MemPool policies, chosen at compile time:
+     *   UncheckedPool  only the exhaustion check, for release builds of
+     *                  the order/book pools
+     *   CheckedPool    also rejects foreign pointers and double frees
+     *   TracedPool     as Checked, and logs every call to stdout
+     * Failure messages are only formatted on the failure path.
+    */
+    struct UncheckedPool {
+        static constexpr bool checked = false;
+        static constexpr bool traced = false;
+    };
+
+    struct CheckedPool {
+        static constexpr bool checked = true;
+        static constexpr bool traced = false;
+    };
+
+    struct TracedPool {
+        static constexpr bool checked = true;
+        static constexpr bool traced = true;
+    };
+
+    /*
+     * Intrusive free list of object blocks, shared by MemPool and
+     * GrowableMemPool. A free block reuses the object's storage for the
+     * link to the next free block, so taking and returning a block is O(1)
+     * however full the pool is, and the most recently freed (cache-hot)
+     * block is reused first. Owners check for exhaustion and ownership;
+     * the list checks a block's free flag under a checked Policy.
+    */
+    template <typename T, typename Policy>
+    class PoolFreeList {
+    public:
+        struct Block {
+            // order from largest to smallest to minimize padding.
+            // T first, so a T* is also a Block*
+            union {
+                T obj_;
+                Block* next_free_;
+            };
+            bool is_free_ = true;
+
+            Block() : next_free_(nullptr) {}
+            ~Block() {}
+        };
+
+        /*
+         * Constructs `count` blocks at `blocks`, linked in address order so
+         * a fresh pool hands out consecutive blocks, and returns the first.
+         * Writes every block, so whoever calls it first-touches the memory;
+         * it does not touch the list, so any thread may prepare blocks.
+        */
+        static Block* link_blocks(Block* blocks, size_t count) {
+            std::uninitialized_default_construct_n(blocks, count);
+            for (size_t i = 0; i + 1 < count; ++i) {
+                blocks[i].next_free_ = &blocks[i + 1];
+            }
+            return count > 0 ? blocks : nullptr;
+        }
+
+        // destroys the objects still live in `blocks`, then the blocks
+        static void destroy_blocks(Block* blocks, size_t count) {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (size_t i = 0; i < count; ++i) {
+                    if (!blocks[i].is_free_) {
+                        std::destroy_at(&blocks[i].obj_);
+                    }
+                }
+            }
+            std::destroy_n(blocks, count);
+        }
+
+        bool empty() const {
+            return head_ == nullptr;
+        }
+
+        // prepends a chain from link_blocks(); only while empty()
+        void splice(Block* first) {
+            head_ = first;
+        }
+
+        // only when !empty()
+        template <typename... A>
+        T* allocate(A&&... args) {
+            Block* block = head_;
+            if constexpr (Policy::checked) {
+                if (UNLIKELY(!block->is_free_)) {
+                    FATAL("Expected free ObjectBlock at " + address(block));
+                }
+            }
+            head_ = block->next_free_;
+            // placement new: constructs the new object in the pool instead
+            // of allocating new heap memory. this ends the lifetime of the
+            // free list link sharing its storage
+            T* obj = new (&block->obj_) T(std::forward<A>(args)...);
+            block->is_free_ = false;
+            ++size_;
+            return obj;
+        }
+
+        // `block` must belong to the owner; checked for double free
+        void deallocate(Block* block) {
+            if constexpr (Policy::checked) {
+                if (UNLIKELY(block->is_free_)) {
+                    FATAL("Expected in-use ObjectBlock at " + address(block));
+                }
+            }
+            std::destroy_at(&block->obj_);
+            block->next_free_ = head_;
+            block->is_free_ = true;
+            head_ = block;
+            --size_;
+        }
+
+        // number of live objects
+        size_t size() const {
+            return size_;
+        }
+
+    private:
+        static std::string address(const Block* block) {
+            return std::to_string(reinterpret_cast<uintptr_t>(block));
+        }
+
+        // nullptr once every block is in use
+        Block* head_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    template <typename T, typename Policy = CheckedPool>
     class MemPool {
     public:
-        explicit MemPool(int capacity) : 
-            capacity_(capacity), 
-            store_(capacity),
-            size_(0), 
-            next_free_idx_(0) {
+        // pass PageSize::Huge2M or Huge1G for large pools to cut dTLB misses.
+        // the store is written here, so pass the owning thread's node as 
+        // `numa_node` if this does not run on that thread
+        explicit MemPool(int capacity, PageSize pages = PageSize::Default, int numa_node = -1) : 
+            pages_(capacity * sizeof(ObjectBlock), pages, alignof(ObjectBlock), numa_node),
+            store_(static_cast<ObjectBlock*>(pages_.data())),
+            capacity_(capacity) {
+                free_list_.splice(FreeList::link_blocks(store_, capacity_));
                 // check that the T object of the first ObjectBlock
                 // has the same address as the first ObjectBlock
-                // in the vector, i.e. check that the T objects are 
+                // in the store, i.e. check that the T objects are 
                 // aligned first in each ObjectBlock for optimal padding
                 // TODO: can use static_assert?
                 ASSERT(    
@@ -24,6 +161,10 @@ namespace common {
                     "T object should be the first member of ObjectBlock"
                 );
             }
+        ~MemPool() {
+            FreeList::destroy_blocks(store_, capacity_);
+        }
+
         MemPool() = delete;
         MemPool(const MemPool&) = delete;
         MemPool(const MemPool&&) = delete;
@@ -37,64 +178,62 @@ namespace common {
         */
         template <typename... A>
         T* allocate(A&&... args) {
-            // start by finding a free index
-            update_next_free_idx();
-            // TODO: check if there's available space. if yes, use 
-            // next_free_idx_ to allocate. if not, use least recently used?
-            ASSERT(size_ < capacity_, "MemPool is full");
-            auto new_block = &store_[next_free_idx_];
-            ASSERT(
-                new_block->is_free_, 
-                "Expected free ObjectBlock at index: " + std::to_string(next_free_idx_)
-            );
-            // placement new: constructs the new object in MemPool instead of 
-            // default behavior of allocating new heap memory
-            T* new_obj = new (&new_block->obj_) T(std::forward<A>(args)...);
-            new_block->is_free_ = false;
-            ++size_;
-            std::cout << "Successfully allocated at index " << next_free_idx_ << 
-            ". New size = " << size_ << std::endl;
+            // pop the head of the free list: O(1) however full the pool is
+            if (UNLIKELY(free_list_.empty())) {
+                FATAL("MemPool is full");
+            }
+            T* new_obj = free_list_.allocate(std::forward<A>(args)...);
+            if constexpr (Policy::traced) {
+                std::cout << "Successfully allocated at index " << 
+                reinterpret_cast<const ObjectBlock*>(new_obj) - store_ << 
+                ". New size = " << size() << std::endl;
+            }
             return new_obj;
         }
 
+        // destroys `obj` and pushes its block onto the free list, so the 
+        // most recently freed (and cache-hot) block is reused first
         void deallocate(const T* obj) {
             // compute the index of the ObjectBlock of `obj` in store_
             const auto dealloc_idx = reinterpret_cast<const ObjectBlock *>(obj) - &store_[0];
-            ASSERT(
-                dealloc_idx >= 0 && static_cast<size_t>(dealloc_idx) < capacity_,
-                "Element being deallocated does not belong to this Memory pool."
-            );
-            ASSERT(
-                !store_[dealloc_idx].is_free_, 
-                "Expected in-use ObjectBlock at index: " + std::to_string(dealloc_idx)
-            );
-            store_[dealloc_idx].is_free_ = true;
-            --size_;
-            std::cout << "Successfully dealloacted at index " << dealloc_idx << 
-            ". New size = " << size_ << std::endl;
+            if constexpr (Policy::checked) {
+                if (UNLIKELY(dealloc_idx < 0 || static_cast<size_t>(dealloc_idx) >= capacity_)) {
+                    FATAL("Element being deallocated does not belong to this Memory pool.");
+                }
+            }
+            free_list_.deallocate(&store_[dealloc_idx]);
+            if constexpr (Policy::traced) {
+                std::cout << "Successfully dealloacted at index " << dealloc_idx << 
+                ". New size = " << size() << std::endl;
+            }
+        }
+
+        // number of live objects
+        size_t size() const {
+            return free_list_.size();
+        }
+
+        size_t capacity() const {
+            return capacity_;
         }
     
+        // which pages actually back the pool
+        PageKind page_kind() const {
+            return pages_.obtained();
+        }
+
+        // node the store lives on, -1 if unknown
+        int numa_node() const {
+            return pages_.numa_node();
+        }
+
     private:
-        struct ObjectBlock {
-            // order from largest to smallest to minimize padding
-            T obj_;
-            bool is_free_ = true;
-        };
+        using FreeList = PoolFreeList<T, Policy>;
+        using ObjectBlock = typename FreeList::Block;
 
-        std::vector<ObjectBlock> store_;
-        size_t size_;
+        PageBuffer pages_;
+        ObjectBlock* store_;
         size_t capacity_;
-        size_t next_free_idx_;
-
-        void update_next_free_idx() {
-            for (size_t i = 0; i < capacity_; ++i) {
-                size_t j = (next_free_idx_+i) % capacity_;
-                if (store_[j].is_free_) {
-                    next_free_idx_ = j;
-                    return;
-                }
-            }
-            FATAL("Unable to find a free ObjectBlock in MemPool");
-        }
+        FreeList free_list_;
     };
-}
\ No newline at end of file
+}
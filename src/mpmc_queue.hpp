@@ -0,0 +1,18 @@
+#pragma once
+
+#include "vyukov_queue.hpp"
+
+namespace common {
+    /*
+     * Bounded multi-producer/multi-consumer queue for handing work to a
+     * pool of background threads (compression, disk writes, analytics).
+     *
+     * Consumers claim positions by CAS on the head the way producers do on
+     * the tail (see VyukovQueue). A claimed ticket has to be finished by
+     * its owner before the slot can be reused, so a thread descheduled
+     * between claim and publish delays whoever lands on that slot a lap
+     * later, but no one else.
+    */
+    template <typename T>
+    using MPMCQueue = VyukovQueue<T, true>;
+}
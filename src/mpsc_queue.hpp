@@ -0,0 +1,14 @@
+#pragma once
+
+#include "vyukov_queue.hpp"
+
+namespace common {
+    /*
+     * Bounded multi-producer/single-consumer queue with the same push/pop
+     * surface as LFQueue. Producers claim slots by CAS on the shared tail;
+     * the single consumer never touches the tail and owns the head, so its
+     * pop is a load, a move and two stores. See VyukovQueue.
+    */
+    template <typename T>
+    using MPSCQueue = VyukovQueue<T, false>;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace common {
+    /*
+     * NUMA helpers built on the raw syscalls and sysfs, so nothing extra
+     * has to be linked. On a single-node machine, or when the kernel
+     * refuses, they return -1 or false and callers carry on as before:
+     * placement is an optimisation, never a requirement.
+    */
+
+    // node that `cpu` belongs to, -1 if unknown
+    inline int numa_node_of_cpu(int cpu) {
+        if (cpu < 0) {
+            return -1;
+        }
+        const std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        DIR* dir = opendir(path.c_str());
+        if (dir == nullptr) {
+            return -1;
+        }
+        int node = -1;
+        while (dirent* entry = readdir(dir)) {
+            // the node is a "nodeN" link in the cpu's directory
+            if (std::strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+                node = std::atoi(entry->d_name + 4);
+                break;
+            }
+        }
+        closedir(dir);
+        return node;
+    }
+
+    // node of the cpu the calling thread is running on right now
+    inline int numa_node_of_current_cpu() {
+        return numa_node_of_cpu(sched_getcpu());
+    }
+
+    // node holding the page at `addr`, -1 if unknown. a page that was
+    // never touched has no node yet
+    inline int numa_node_of_address(const void* addr) {
+        int node = -1;
+        if (syscall(SYS_get_mempolicy, &node, nullptr, 0, const_cast<void*>(addr), MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+            return -1;
+        }
+        return node;
+    }
+
+    // binds the page-aligned range to `node`, moving any pages already
+    // faulted in. pages that are not yet touched are allocated on `node`
+    // whichever thread touches them first
+    inline bool numa_bind(void* addr, size_t len, int node) {
+        if (node < 0 || node >= static_cast<int>(8 * sizeof(unsigned long))) {
+            return false;
+        }
+        const unsigned long mask = 1UL << node;
+        return syscall(SYS_mbind, addr, len, MPOL_BIND, &mask, 8 * sizeof(unsigned long), MPOL_MF_MOVE) == 0;
+    }
+
+    // new pages the calling thread faults in come from `node` when it has
+    // memory, even if the process was started with another policy (e.g.
+    // numactl --interleave)
+    inline bool numa_prefer_node(int node) {
+        if (node < 0 || node >= static_cast<int>(8 * sizeof(unsigned long))) {
+            return false;
+        }
+        const unsigned long mask = 1UL << node;
+        return syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, 8 * sizeof(unsigned long)) == 0;
+    }
+
+    /*
+     * Startup check that `addr` lives on `node`. Prints a warning on
+     * stderr and returns false if it does not; an unknown placement counts
+     * as fine.
+    */
+    inline bool check_numa_node(const std::string& name, const void* addr, int node) {
+        const int actual = numa_node_of_address(addr);
+        if (node < 0 || actual < 0 || node == actual) {
+            return true;
+        }
+        std::cerr << "NUMA: " << name << " lives on node " << actual << ", expected node " <<
+            node << ", every access from there is remote" << std::endl;
+        return false;
+    }
+
+    // as check_numa_node, for memory the thread on `cpu` will use most
+    // (e.g. a ring it reads)
+    inline bool check_numa_placement(const std::string& name, const void* addr, int cpu) {
+        return check_numa_node(name + " (used from cpu " + std::to_string(cpu) + ")", addr, numa_node_of_cpu(cpu));
+    }
+}
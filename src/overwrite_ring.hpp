@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "cache_line.hpp"
+#include "pow2.hpp"
+#include "seqlock.hpp"
+
+namespace common {
+    /*
+     * Lossy single-producer broadcast ring for latest-state data (top of
+     * book, ticker). The producer never blocks and never reads anything a
+     * consumer writes: when the ring is full it simply overwrites the
+     * oldest slot. Readers keep their own cursor and detect when they have
+     * been lapped, count what they skipped and jump to the newest entry.
+     *
+     * Each slot is a small seqlock: its sequence is odd while the producer
+     * is writing it and 2 * (position + 1) once position `position` is
+     * complete, so a reader can tell "not written yet", "mine" and
+     * "overwritten by a later lap" apart and retries a torn copy.
+     *
+     * Element bytes are copied with the seqlock word helpers from
+     * seqlock.hpp; T must be trivially copyable.
+    */
+    template <typename T>
+    class OverwriteRing {
+    private:
+        static_assert(
+            std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+            "OverwriteRing elements are copied racily and must be trivially copyable."
+        );
+
+        struct alignas(hardware_destructive_interference_size) Cell {
+            std::atomic<uint64_t> seq_{0};
+            uint64_t words_[seqlock_words<T>];
+        };
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+        // number of entries published; readers only need it after a lap
+        alignas(hardware_destructive_interference_size) std::atomic<size_t> write_pos_{0};
+
+    public:
+        /*
+         * One per consumer thread. Holds nothing but a cursor and counters,
+         * all private to the reading thread, so any number of readers add
+         * no shared writes.
+        */
+        class Reader {
+        public:
+            // next unread entry; nullopt if the reader is caught up
+            std::optional<T> read() {
+                for (;;) {
+                    Cell& cell = ring_.cells_[pos_ & ring_.mask_];
+                    const uint64_t expected = 2 * (pos_ + 1);
+                    const uint64_t seq = cell.seq_.load(std::memory_order_acquire);
+                    if (seq == expected) {
+                        T out;
+                        // acquire word loads keep the re-check after the copy.
+                        // the re-check is acquire too: if it sees a later
+                        // lap, lapped() then sees that lap's write_pos_
+                        seqlock_load_words(cell.words_, out);
+                        if (cell.seq_.load(std::memory_order_acquire) == expected) {
+                            ++pos_;
+                            last_skipped_ = pending_skipped_;
+                            pending_skipped_ = 0;
+                            return out;
+                        }
+                        // overwritten while we copied: we have been lapped
+                    } else if (seq < expected) {
+                        // position not written yet (or, if odd, being
+                        // written for the first time)
+                        return std::nullopt;
+                    }
+                    lapped();
+                }
+            }
+
+            // skips straight to the newest entry, counting what was passed
+            std::optional<T> read_latest() {
+                const size_t write_pos = ring_.write_pos_.load(std::memory_order_acquire);
+                if (write_pos > pos_ + 1) {
+                    pending_skipped_ += write_pos - 1 - pos_;
+                    skipped_ += write_pos - 1 - pos_;
+                    pos_ = write_pos - 1;
+                }
+                return read();
+            }
+
+            // entries this reader never saw because it was lapped or
+            // called read_latest(), in total and just before the last read
+            size_t skipped() const {
+                return skipped_;
+            }
+
+            size_t last_skipped() const {
+                return last_skipped_;
+            }
+
+        private:
+            friend class OverwriteRing;
+
+            Reader(OverwriteRing& ring, size_t pos) : ring_(ring), pos_(pos) {}
+
+            void lapped() {
+                // the producer is at least a lap ahead: jump to its newest
+                // complete entry. if write_pos_ does not show that yet,
+                // leave pos_ alone and let read() retry
+                const size_t write_pos = ring_.write_pos_.load(std::memory_order_acquire);
+                if (write_pos > pos_ + 1) {
+                    const size_t newest = write_pos - 1;
+                    pending_skipped_ += newest - pos_;
+                    skipped_ += newest - pos_;
+                    pos_ = newest;
+                }
+            }
+
+            OverwriteRing& ring_;
+            size_t pos_;
+            size_t skipped_ = 0;
+            size_t last_skipped_ = 0;
+            size_t pending_skipped_ = 0;
+        };
+
+        // capacity is rounded up to a power of two
+        explicit OverwriteRing(int capacity) :
+            capacity_(round_up_pow2(capacity)),
+            mask_(capacity_ - 1),
+            cells_(new Cell[capacity_]) {}
+
+        OverwriteRing() = delete;
+        OverwriteRing(const OverwriteRing&) = delete;
+        OverwriteRing(const OverwriteRing&&) = delete;
+        OverwriteRing& operator=(const OverwriteRing&) = delete;
+        OverwriteRing& operator=(const OverwriteRing&&) = delete;
+
+        // never fails and never waits for readers. single producer only
+        void push(const T& obj) {
+            const size_t pos = write_pos_.load(std::memory_order_relaxed);
+            Cell& cell = cells_[pos & mask_];
+            // release: a reader that sees the odd seq also sees every
+            // earlier write_pos_ publish
+            cell.seq_.store(2 * pos + 1, std::memory_order_release);
+            // release word stores: a reader seeing any of them sees the odd seq
+            seqlock_store_words(cell.words_, obj);
+            cell.seq_.store(2 * (pos + 1), std::memory_order_release);
+            write_pos_.store(pos + 1, std::memory_order_release);
+        }
+
+        // a reader that starts with the next entry to be published
+        Reader reader() {
+            return Reader(*this, write_pos_.load(std::memory_order_acquire));
+        }
+
+        // number of entries published so far
+        size_t sequence() const {
+            return write_pos_.load(std::memory_order_acquire);
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+    };
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <linux/mman.h>
+#include <sys/mman.h>
+
+#include "cache_line.hpp"
+#include "numa.hpp"
+
+namespace common {
+    // what a structure asks for
+    enum class PageSize {
+        Default,
+        Huge2M,
+        Huge1G,
+    };
+
+    // what it actually got
+    enum class PageKind {
+        // ordinary heap memory
+        Default,
+        // 2M-aligned anonymous mapping with MADV_HUGEPAGE: the kernel backs
+        // it with transparent huge pages when it can, which is likely but
+        // not guaranteed
+        TransparentHuge,
+        // reserved hugetlbfs pages, guaranteed
+        Huge2M,
+        Huge1G,
+    };
+
+    inline const char* to_string(PageKind kind) {
+        switch (kind) {
+            case PageKind::Default: return "default pages";
+            case PageKind::TransparentHuge: return "transparent huge pages (advised)";
+            case PageKind::Huge2M: return "2M huge pages";
+            case PageKind::Huge1G: return "1G huge pages";
+        }
+        return "unknown";
+    }
+
+    /*
+     * Storage for a large hot structure (an LFQueue ring, a MemPool store)
+     * that can be backed by huge pages, so that a ring of a million slots
+     * costs a handful of dTLB entries instead of thousands.
+     *
+     * Huge2M/Huge1G first try MAP_HUGETLB with the requested size, which
+     * needs pages reserved up front (vm.nr_hugepages, or hugepages=/
+     * hugepagesz= on the kernel command line for 1G). A 1G request then
+     * tries 2M. If no reserved pages are available the buffer falls back
+     * to a 2M-aligned mapping with madvise(MADV_HUGEPAGE), unless THP is
+     * disabled system-wide, and finally to the heap. Every fallback is
+     * reported on stderr once, at construction, and obtained() says what
+     * the buffer ended up with.
+     *
+     * The memory is zero-filled for the mmap kinds and uninitialized for
+     * Default; either way it is aligned to at least a cache line, or to
+     * `align` if that is larger. Huge page sizes round the mapping up to a
+     * whole number of pages.
+     *
+     * `numa_node` >= 0 binds the pages to that node (mbind), so they are
+     * local to e.g. the consumer no matter which thread constructs the
+     * structure. Default pages are then mapped rather than taken from the
+     * heap, since only whole pages can be bound. A bound buffer is faulted
+     * in at construction and a placement off `numa_node` is reported; a
+     * failed bind is reported and otherwise ignored. Without a node,
+     * first_touch() from the pinned thread gets the same effect under the
+     * default policy.
+    */
+    class PageBuffer {
+    public:
+        static constexpr size_t SIZE_2M = size_t{1} << 21;
+        static constexpr size_t SIZE_1G = size_t{1} << 30;
+
+        PageBuffer(size_t bytes, PageSize pages, size_t align = hardware_destructive_interference_size,
+                   int numa_node = -1) :
+            bytes_(bytes),
+            align_(align > hardware_destructive_interference_size ? align : hardware_destructive_interference_size) {
+            allocate(pages, numa_node >= 0);
+            if (numa_node >= 0 && mapping_ != nullptr) {
+                if (numa_bind(mapping_, mapped_bytes_, numa_node)) {
+                    // fault the pages in now, so where they landed is known
+                    // (and reported) at startup rather than on first use
+                    first_touch();
+                    check_numa_node("PageBuffer of " + std::to_string(bytes_) + " bytes", data_, numa_node);
+                } else {
+                    const int error = errno;
+                    report("could not bind to node " + std::to_string(numa_node) +
+                        " (" + std::strerror(error) + ")");
+                }
+            }
+        }
+
+        ~PageBuffer() {
+            if (mapping_ == nullptr) {
+                ::operator delete(data_, std::align_val_t{align_});
+            } else {
+                munmap(mapping_, mapped_bytes_);
+            }
+        }
+
+        PageBuffer() = delete;
+        PageBuffer(const PageBuffer&) = delete;
+        PageBuffer(const PageBuffer&&) = delete;
+        PageBuffer& operator=(const PageBuffer&) = delete;
+        PageBuffer& operator=(const PageBuffer&&) = delete;
+
+        void* data() const {
+            return data_;
+        }
+
+        // as requested, not rounded up
+        size_t bytes() const {
+            return bytes_;
+        }
+
+        PageKind obtained() const {
+            return kind_;
+        }
+
+        /*
+         * Faults in every page from the calling thread without changing
+         * its contents, so under the default NUMA policy the memory lands
+         * on this thread's node. Call it from the pinned thread that will
+         * use the memory most, before anyone else touches it.
+        */
+        void first_touch() {
+            constexpr size_t PAGE = 4096;
+            auto* bytes = static_cast<volatile char*>(data_);
+            for (size_t i = 0; i < bytes_; i += PAGE) {
+                bytes[i] = bytes[i];
+            }
+        }
+
+        // node of the first page, -1 if unknown or not yet touched
+        int numa_node() const {
+            return numa_node_of_address(data_);
+        }
+
+    private:
+        static size_t round_up(size_t n, size_t to) {
+            return (n + to - 1) / to * to;
+        }
+
+        void allocate(PageSize pages, bool needs_mapping) {
+            if (pages == PageSize::Huge1G) {
+                if (map_hugetlb(SIZE_1G, MAP_HUGE_1GB)) {
+                    kind_ = PageKind::Huge1G;
+                    return;
+                }
+                report("1G huge pages unavailable (" + std::string(std::strerror(errno)) + ")");
+            }
+            if (pages != PageSize::Default) {
+                if (map_hugetlb(SIZE_2M, MAP_HUGE_2MB)) {
+                    kind_ = PageKind::Huge2M;
+                    return;
+                }
+                report("2M huge pages unavailable (" + std::string(std::strerror(errno)) + ")");
+                if (thp_enabled() && map_transparent()) {
+                    kind_ = PageKind::TransparentHuge;
+                    report("falling back to " + std::string(to_string(kind_)));
+                    return;
+                }
+                report("falling back to " + std::string(to_string(PageKind::Default)));
+            }
+            kind_ = PageKind::Default;
+            if (needs_mapping && map_default()) {
+                return;
+            }
+            data_ = ::operator new(bytes_, std::align_val_t{align_});
+        }
+
+        static void report(const std::string& what) {
+            std::cerr << "PageBuffer: " << what << std::endl;
+        }
+
+        // "always [madvise] never": only "never" makes the advice useless
+        static bool thp_enabled() {
+            std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+            std::string setting;
+            std::getline(file, setting);
+            return setting.find("[never]") == std::string::npos;
+        }
+
+        bool map_hugetlb(size_t page_size, int size_flag) {
+            const size_t len = round_up(bytes_, page_size);
+            void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | size_flag, -1, 0);
+            if (p == MAP_FAILED) {
+                return false;
+            }
+            mapping_ = p;
+            mapped_bytes_ = len;
+            data_ = p;
+            return true;
+        }
+
+        bool map_default() {
+            const size_t len = round_up(bytes_ > 0 ? bytes_ : 1, 4096);
+            void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                return false;
+            }
+            mapping_ = p;
+            mapped_bytes_ = len;
+            data_ = p;
+            return true;
+        }
+
+        // over-map by 2M and trim so the usable range starts on a 2M
+        // boundary, otherwise the kernel cannot use a huge page for the
+        // first (and often the only) 2M of the buffer
+        bool map_transparent() {
+            const size_t len = round_up(bytes_, SIZE_2M);
+            void* p = mmap(nullptr, len + SIZE_2M, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                return false;
+            }
+            const auto raw = reinterpret_cast<uintptr_t>(p);
+            const uintptr_t aligned = round_up(raw, SIZE_2M);
+            if (aligned > raw) {
+                munmap(p, aligned - raw);
+            }
+            const size_t tail = raw + SIZE_2M - aligned;
+            if (tail > 0) {
+                munmap(reinterpret_cast<void*>(aligned + len), tail);
+            }
+            mapping_ = reinterpret_cast<void*>(aligned);
+            mapped_bytes_ = len;
+            data_ = mapping_;
+            madvise(mapping_, mapped_bytes_, MADV_HUGEPAGE);
+            return true;
+        }
+
+        const size_t bytes_;
+        const size_t align_;
+        void* data_ = nullptr;
+        void* mapping_ = nullptr;
+        size_t mapped_bytes_ = 0;
+        PageKind kind_ = PageKind::Default;
+    };
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+
+namespace common {
+    // smallest power of two >= n (1 for 0), for rings that index by mask
+    constexpr size_t round_up_pow2(size_t n) {
+        return std::bit_ceil(n);
+    }
+
+    constexpr bool is_pow2(size_t n) {
+        return std::has_single_bit(n);
+    }
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace common {
+    // per-queue service statistics, see QueuePoller::stats()
+    struct QueueStats {
+        // passes in which the queue had data and was drained
+        uint64_t services = 0;
+        uint64_t messages = 0;
+        // services that hit the batch limit, i.e. the queue had a backlog
+        uint64_t full_batches = 0;
+        uint64_t max_batch = 0;
+    };
+
+    // one queue of a QueuePoller, see poll_source()
+    template <typename Queue, typename Handler>
+    struct PollSource {
+        Queue& queue_;
+        Handler handler_;
+        int priority_;
+        size_t batch_limit_;
+    };
+
+    /*
+     * `handler` is called as handler(T&) for every element of `queue`.
+     * The queue must outlive the poller.
+    */
+    template <typename Queue, typename Handler>
+    PollSource<Queue, std::decay_t<Handler>> poll_source(Queue& queue, Handler&& handler, int priority, size_t batch_limit) {
+        return {queue, std::forward<Handler>(handler), priority, batch_limit};
+    }
+
+    /*
+     * Drains several SPSC queues (trades, level2, order acks, control...)
+     * from one consumer thread.
+     *
+     * Each call to poll() is one pass over the queues in priority order,
+     * highest first, argument order among equals. Every non-empty queue is
+     * drained up to its own batch limit, so a flooded low-priority queue
+     * cannot starve anything, and a high-priority queue waits for at most
+     * one batch from each lower-priority queue before it is serviced again.
+     * Empty queues cost one load of their write cursor. While a queue is
+     * being drained, the next slot of the next non-empty queue is
+     * prefetched.
+     *
+     * The set of queues is fixed when the poller is built, so it is part
+     * of the type and every drain is a direct, inlinable call:
+     *
+     *   QueuePoller poller(poll_source(trades, on_trade, 0, 16),
+     *                      poll_source(control, on_control, 10, 4));
+     *
+     * Queues need the consumer surface of LFQueue: drain(cb, max), empty()
+     * and prefetch_next().
+    */
+    template <typename... Sources>
+    class QueuePoller {
+    private:
+        static constexpr size_t N = sizeof...(Sources);
+
+    public:
+        explicit QueuePoller(Sources... sources) : sources_(std::move(sources)...) {
+            // sort once here so poll() is a straight walk
+            const auto priorities = std::apply([](const auto&... source) {
+                return std::array<int, N>{source.priority_...};
+            }, sources_);
+            std::iota(order_.begin(), order_.end(), 0);
+            std::stable_sort(order_.begin(), order_.end(), [&](size_t a, size_t b) {
+                return priorities[a] > priorities[b];
+            });
+        }
+
+        QueuePoller() = delete;
+        QueuePoller(const QueuePoller&) = delete;
+        QueuePoller(const QueuePoller&&) = delete;
+        QueuePoller& operator=(const QueuePoller&) = delete;
+        QueuePoller& operator=(const QueuePoller&&) = delete;
+
+        // one pass over all queues, returns the number of elements handled
+        size_t poll() {
+            size_t total = 0;
+            size_t i = next_non_empty(0);
+            while (i < N) {
+                const size_t next = next_non_empty(i + 1);
+                if (next < N) {
+                    visit(order_[next], [](size_t, auto& source) {
+                        source.queue_.prefetch_next();
+                    });
+                }
+                visit(order_[i], [&](size_t id, auto& source) {
+                    total += service(id, source);
+                });
+                i = next;
+            }
+            return total;
+        }
+
+        // `id` is the position of the queue among the constructor arguments
+        const QueueStats& stats(size_t id) const {
+            return stats_[id];
+        }
+
+        static constexpr size_t size() {
+            return N;
+        }
+
+    private:
+        // calls f(id, source) on source `id`; a chain of compares the
+        // compiler can inline rather than an indirect call
+        template <typename F>
+        void visit(size_t id, F&& f) {
+            visit_impl(id, f, std::index_sequence_for<Sources...>{});
+        }
+
+        template <typename F, size_t... I>
+        void visit_impl(size_t id, F& f, std::index_sequence<I...>) {
+            ((id == I ? (f(I, std::get<I>(sources_)), true) : false) || ...);
+        }
+
+        // first position in `order_` at or after `from` with data
+        size_t next_non_empty(size_t from) {
+            while (from < N) {
+                bool empty = true;
+                visit(order_[from], [&](size_t, auto& source) {
+                    empty = source.queue_.empty();
+                });
+                if (!empty) {
+                    break;
+                }
+                ++from;
+            }
+            return from;
+        }
+
+        template <typename Source>
+        size_t service(size_t id, Source& source) {
+            const size_t n = source.queue_.drain(source.handler_, source.batch_limit_);
+            QueueStats& stats = stats_[id];
+            if (n > 0) {
+                ++stats.services;
+                stats.messages += n;
+                stats.max_batch = std::max<uint64_t>(stats.max_batch, n);
+                if (n == source.batch_limit_) {
+                    ++stats.full_batches;
+                }
+            }
+            return n;
+        }
+
+        std::tuple<Sources...> sources_;
+        // source ids sorted by priority, highest first
+        std::array<size_t, N> order_;
+        // indexed by id, i.e. argument order
+        std::array<QueueStats, N> stats_{};
+    };
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "cache_line.hpp"
+#include "lock_free_queue.hpp"
+#include "macros.hpp"
+#include "mem_pool.hpp"
+
+namespace common {
+    /*
+     * Unbounded SPSC queue for background consumers (journaling, logging)
+     * where the hot thread must neither drop data nor wait.
+     *
+     * Elements live in fixed-size segments of `SegmentSize` slots linked
+     * into a list. When the producer fills its segment it links the next
+     * one and moves on; when the consumer finishes a segment it hands it
+     * back. All segments come from a MemPool sized up front, so the hot
+     * path never touches the heap and memory is bounded by
+     * `max_segments * SegmentSize` elements.
+     *
+     * MemPool is single-threaded, so only the producer allocates from and
+     * deallocates to it: the consumer returns drained segments through a
+     * second SPSC queue running the other way, and the producer puts them
+     * back into the pool the next time it needs a segment.
+     *
+     * push() never fails. Running out of segments means the consumer is
+     * hopelessly behind and is FATAL, same as an exhausted MemPool.
+    */
+    template <typename T, size_t SegmentSize = 1024>
+    class SegmentedQueue {
+    private:
+        static_assert(SegmentSize > 0, "SegmentSize must be at least 1.");
+
+        struct Segment {
+            // number of slots published, written by the producer only
+            alignas(hardware_destructive_interference_size) std::atomic<size_t> committed_{0};
+            // set once by the producer when it moves on to the next segment
+            std::atomic<Segment*> next_{nullptr};
+            alignas(hardware_destructive_interference_size) RawSlot<T> slots_[SegmentSize];
+
+            T* slot(size_t idx) {
+                return reinterpret_cast<T*>(slots_[idx].bytes_);
+            }
+        };
+
+        Segment* new_segment() {
+            // give everything the consumer is done with back to the pool
+            // first; the recycle queue can hold every segment, so the
+            // consumer never has to wait on it
+            while (std::optional<Segment*> seg = recycled_.pop()) {
+                pool_.deallocate(*seg);
+                --live_segments_;
+            }
+            if (UNLIKELY(live_segments_ == max_segments_)) {
+                FATAL("SegmentedQueue out of segments: all " + std::to_string(max_segments_) +
+                    " segments of " + std::to_string(SegmentSize) + " elements are in use");
+            }
+            ++live_segments_;
+            return pool_.allocate();
+        }
+
+        const size_t max_segments_;
+        MemPool<Segment> pool_;
+        // drained segments on their way back from consumer to producer
+        LFQueue<Segment*> recycled_;
+
+        // producer line
+        alignas(hardware_destructive_interference_size) Segment* tail_;
+        size_t write_pos_{0};
+        size_t live_segments_{0};
+        // consumer line
+        alignas(hardware_destructive_interference_size) Segment* head_;
+        size_t read_pos_{0};
+
+    public:
+        // `max_segments` bounds memory; at least two are needed so the
+        // producer can move on while the consumer still reads the old one
+        explicit SegmentedQueue(int max_segments) :
+            max_segments_(max_segments),
+            pool_(max_segments),
+            recycled_(max_segments) {
+                ASSERT(max_segments >= 2, "SegmentedQueue needs at least 2 segments");
+                tail_ = new_segment();
+                head_ = tail_;
+            }
+
+        ~SegmentedQueue() {
+            Segment* seg = head_;
+            size_t pos = read_pos_;
+            while (seg != nullptr) {
+                if constexpr (!std::is_trivially_destructible_v<T>) {
+                    const size_t committed = seg->committed_.load(std::memory_order_acquire);
+                    for (; pos < committed; ++pos) {
+                        std::destroy_at(seg->slot(pos));
+                    }
+                }
+                Segment* next = seg->next_.load(std::memory_order_acquire);
+                pool_.deallocate(seg);
+                seg = next;
+                pos = 0;
+            }
+            while (std::optional<Segment*> recycled = recycled_.pop()) {
+                pool_.deallocate(*recycled);
+            }
+        }
+
+        SegmentedQueue() = delete;
+        SegmentedQueue(const SegmentedQueue&) = delete;
+        SegmentedQueue(const SegmentedQueue&&) = delete;
+        SegmentedQueue& operator=(const SegmentedQueue&) = delete;
+        SegmentedQueue& operator=(const SegmentedQueue&&) = delete;
+
+        // producer thread only. always succeeds
+        template <typename U>
+        void push(U&& obj) {
+            static_assert(
+                std::is_same<T, std::decay_t<U>>::value,
+                "Type U must be the same as SegmentedQueue element type T"
+            );
+            if (UNLIKELY(write_pos_ == SegmentSize)) {
+                Segment* seg = new_segment();
+                // the last thing the producer does with the old segment;
+                // from here on the consumer may recycle it
+                tail_->next_.store(seg, std::memory_order_release);
+                tail_ = seg;
+                write_pos_ = 0;
+            }
+            new (tail_->slot(write_pos_)) T(std::forward<U>(obj));
+            tail_->committed_.store(++write_pos_, std::memory_order_release);
+        }
+
+        // consumer thread only
+        std::optional<T> pop() {
+            if (UNLIKELY(read_pos_ == SegmentSize)) {
+                Segment* next = head_->next_.load(std::memory_order_acquire);
+                if (next == nullptr) {
+                    return std::nullopt;
+                }
+                // cannot fail: the recycle queue holds every segment
+                recycled_.push(head_);
+                head_ = next;
+                read_pos_ = 0;
+            }
+            if (read_pos_ == head_->committed_.load(std::memory_order_acquire)) {
+                return std::nullopt;
+            }
+            T* elem = head_->slot(read_pos_++);
+            std::optional<T> out(std::move(*elem));
+            std::destroy_at(elem);
+            return out;
+        }
+
+        // producer side: segments currently taken from the pool, including
+        // drained ones the producer has not reclaimed yet
+        size_t segments_in_use() const {
+            return live_segments_;
+        }
+
+        size_t max_segments() const {
+            return max_segments_;
+        }
+
+        static constexpr size_t segment_size() {
+            return SegmentSize;
+        }
+    };
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include "cache_line.hpp"
+#include "wait_strategy.hpp"
+
+namespace common {
+    // number of 64-bit words needed to hold a T
+    template <typename T>
+    inline constexpr size_t seqlock_words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    /*
+     * Copy a trivially copyable T into/out of word storage with atomic
+     * accesses. A seqlock reader races with the writer by design; going
+     * through atomic words keeps that race well defined (and visible to
+     * TSan as such) while compiling to plain moves on x86.
+     *
+     * The words are stored with release and loaded with acquire, which is
+     * what orders the version checks around the copy without fences: a
+     * reader that sees any word of a newer write also sees the odd version
+     * stored before it, so its re-check fails.
+    */
+    template <typename T>
+    inline void seqlock_store_words(uint64_t* dst, const T& obj) {
+        uint64_t buf[seqlock_words<T>] = {};
+        std::memcpy(buf, &obj, sizeof(T));
+        for (size_t i = 0; i < seqlock_words<T>; ++i) {
+            std::atomic_ref<uint64_t>(dst[i]).store(buf[i], std::memory_order_release);
+        }
+    }
+
+    template <typename T>
+    inline void seqlock_load_words(uint64_t* src, T& out) {
+        uint64_t buf[seqlock_words<T>];
+        for (size_t i = 0; i < seqlock_words<T>; ++i) {
+            buf[i] = std::atomic_ref<uint64_t>(src[i]).load(std::memory_order_acquire);
+        }
+        std::memcpy(&out, buf, sizeof(T));
+    }
+
+    /*
+     * Single-writer seqlock around one value. The version is odd while a
+     * write is in progress; readers copy the value and retry if the version
+     * was odd or changed under them. Readers never write shared memory, so
+     * any number of them can poll without bouncing the line.
+     *
+     * Aligned to a cache line so neighbouring seqlocks (see SnapshotTable)
+     * never share one.
+    */
+    template <typename T>
+    class alignas(hardware_destructive_interference_size) Seqlock {
+    private:
+        static_assert(
+            std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+            "Seqlock values are copied racily and must be trivially copyable."
+        );
+
+        std::atomic<uint64_t> version_{0};
+        mutable uint64_t words_[seqlock_words<T>] = {};
+
+    public:
+        // writer thread only
+        void store(const T& value) {
+            const uint64_t version = version_.load(std::memory_order_relaxed);
+            version_.store(version + 1, std::memory_order_relaxed);
+            // release stores: published no earlier than the odd version
+            seqlock_store_words(words_, value);
+            version_.store(version + 2, std::memory_order_release);
+        }
+
+        // false if the copy was torn by a concurrent store(); `out` is then
+        // unspecified
+        bool try_load(T& out) const {
+            const uint64_t version = version_.load(std::memory_order_acquire);
+            if (version & 1) {
+                return false;
+            }
+            // acquire loads: the re-check below cannot move above the copy
+            seqlock_load_words(words_, out);
+            return version_.load(std::memory_order_relaxed) == version;
+        }
+
+        T load() const {
+            T out;
+            while (!try_load(out)) {
+                cpu_relax();
+            }
+            return out;
+        }
+
+        // even number that changes on every store; lets a reader skip the
+        // copy when nothing was published since it last looked
+        uint64_t version() const {
+            return version_.load(std::memory_order_acquire) & ~uint64_t{1};
+        }
+    };
+
+    /*
+     * Latest value per product (e.g. best bid/ask/last trade), published
+     * by one writer thread and polled by any number of readers. One
+     * cache-line-aligned Seqlock per product id in [0, num_products).
+    */
+    template <typename T>
+    class SnapshotTable {
+    public:
+        explicit SnapshotTable(size_t num_products) :
+            num_products_(num_products),
+            slots_(new Seqlock<T>[num_products]) {}
+
+        SnapshotTable() = delete;
+        SnapshotTable(const SnapshotTable&) = delete;
+        SnapshotTable(const SnapshotTable&&) = delete;
+        SnapshotTable& operator=(const SnapshotTable&) = delete;
+        SnapshotTable& operator=(const SnapshotTable&&) = delete;
+
+        void publish(size_t product_id, const T& value) {
+            slots_[product_id].store(value);
+        }
+
+        T read(size_t product_id) const {
+            return slots_[product_id].load();
+        }
+
+        bool try_read(size_t product_id, T& out) const {
+            return slots_[product_id].try_load(out);
+        }
+
+        uint64_t version(size_t product_id) const {
+            return slots_[product_id].version();
+        }
+
+        size_t size() const {
+            return num_products_;
+        }
+
+    private:
+        const size_t num_products_;
+        std::unique_ptr<Seqlock<T>[]> slots_;
+    };
+}
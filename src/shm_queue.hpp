@@ -0,0 +1,251 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache_line.hpp"
+#include "pow2.hpp"
+
+namespace common {
+    /*
+     * SPSC queue between two processes, e.g. the feed handler and a
+     * strategy, so that one crashing does not take the other down.
+     *
+     * The header and the ring live in a named POSIX shared memory object
+     * (/dev/shm/<name>). The algorithm is the one FixedLFQueue uses:
+     * monotonically increasing cursors wrapped with a mask, and each side
+     * keeps its cached copy of the other side's cursor in its own process,
+     * so a hand-off costs the same as the in-process SPSC path.
+     *
+     * The creating side owns the name and unlinks it on destruction. The
+     * attaching side validates magic, layout version, element size and
+     * capacity before touching the ring. Both factories return nullptr,
+     * with the reason on stderr, if the mapping cannot be used.
+     *
+     * T must be trivially copyable: the bytes are read by another process
+     * that may map the segment at a different address.
+    */
+    template <typename T>
+    class ShmLFQueue {
+    private:
+        static_assert(
+            std::is_trivially_copyable_v<T>,
+            "ShmLFQueue elements are shared between processes and must be trivially copyable."
+        );
+        // process-shared atomics have to be address-free, i.e. lock-free
+        static_assert(
+            std::atomic<size_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+            "atomics in shared memory must be lock-free."
+        );
+
+        static constexpr uint64_t MAGIC = 0x48465453484d5131; // "HFTSHMQ1"
+        static constexpr uint32_t VERSION = 1;
+
+        struct Header {
+            uint64_t magic_;
+            uint32_t version_;
+            uint32_t element_size_;
+            uint64_t element_align_;
+            uint64_t capacity_;
+            // set last by the creator, once everything above is valid
+            std::atomic<uint32_t> initialized_;
+            alignas(hardware_destructive_interference_size) std::atomic<size_t> write_idx_;
+            alignas(hardware_destructive_interference_size) std::atomic<size_t> read_idx_;
+        };
+
+        static constexpr size_t slots_offset() {
+            constexpr size_t align = alignof(T) > hardware_destructive_interference_size
+                ? alignof(T) : hardware_destructive_interference_size;
+            return (sizeof(Header) + align - 1) / align * align;
+        }
+
+        static size_t mapping_size(size_t capacity) {
+            return slots_offset() + capacity * sizeof(T);
+        }
+
+        static void report(const std::string& name, const std::string& what) {
+            std::cerr << "ShmLFQueue " << name << ": " << what << std::endl;
+        }
+
+        ShmLFQueue(std::string name, int fd, void* base, size_t bytes, bool owner) :
+            name_(std::move(name)),
+            fd_(fd),
+            base_(base),
+            bytes_(bytes),
+            owner_(owner),
+            header_(static_cast<Header*>(base)),
+            slots_(reinterpret_cast<T*>(static_cast<char*>(base) + slots_offset())),
+            capacity_(header_->capacity_),
+            mask_(capacity_ - 1),
+            // a side that re-attaches after a crash starts from wherever
+            // the cursors are now, not from 0
+            cached_read_idx_(header_->read_idx_.load(std::memory_order_acquire)),
+            cached_write_idx_(header_->write_idx_.load(std::memory_order_acquire)) {}
+
+        std::string name_;
+        int fd_;
+        void* base_;
+        size_t bytes_;
+        bool owner_;
+        Header* header_;
+        T* slots_;
+        size_t capacity_;
+        size_t mask_;
+        // process-local caches of the other side's cursor; each process is
+        // only ever one side so these never bounce between cores
+        size_t cached_read_idx_;
+        size_t cached_write_idx_;
+
+    public:
+        ShmLFQueue(const ShmLFQueue&) = delete;
+        ShmLFQueue(const ShmLFQueue&&) = delete;
+        ShmLFQueue& operator=(const ShmLFQueue&) = delete;
+        ShmLFQueue& operator=(const ShmLFQueue&&) = delete;
+
+        ~ShmLFQueue() {
+            munmap(base_, bytes_);
+            close(fd_);
+            if (owner_) {
+                shm_unlink(name_.c_str());
+            }
+        }
+
+        // `name` is a POSIX shm name, e.g. "/md_to_strategy". `capacity` is
+        // rounded up to a power of two. fails if the name already exists
+        static std::unique_ptr<ShmLFQueue> create(const std::string& name, size_t capacity) {
+            const size_t pow2 = round_up_pow2(capacity);
+            const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd == -1) {
+                report(name, std::string("shm_open failed: ") + std::strerror(errno));
+                return nullptr;
+            }
+            const size_t bytes = mapping_size(pow2);
+            // ftruncate zero-fills, so both cursors start at 0
+            if (ftruncate(fd, bytes) == -1) {
+                report(name, std::string("ftruncate failed: ") + std::strerror(errno));
+                close(fd);
+                shm_unlink(name.c_str());
+                return nullptr;
+            }
+            void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED) {
+                report(name, std::string("mmap failed: ") + std::strerror(errno));
+                close(fd);
+                shm_unlink(name.c_str());
+                return nullptr;
+            }
+            Header* header = new (base) Header{};
+            header->magic_ = MAGIC;
+            header->version_ = VERSION;
+            header->element_size_ = sizeof(T);
+            header->element_align_ = alignof(T);
+            header->capacity_ = pow2;
+            header->initialized_.store(1, std::memory_order_release);
+            return std::unique_ptr<ShmLFQueue>(new ShmLFQueue(name, fd, base, bytes, true));
+        }
+
+        // attaches to a queue created by another process (or this one)
+        static std::unique_ptr<ShmLFQueue> attach(const std::string& name) {
+            const int fd = shm_open(name.c_str(), O_RDWR, 0);
+            if (fd == -1) {
+                report(name, std::string("shm_open failed: ") + std::strerror(errno));
+                return nullptr;
+            }
+            struct stat st;
+            if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < slots_offset()) {
+                report(name, "segment is too small to hold a queue header");
+                close(fd);
+                return nullptr;
+            }
+            const size_t bytes = st.st_size;
+            void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED) {
+                report(name, std::string("mmap failed: ") + std::strerror(errno));
+                close(fd);
+                return nullptr;
+            }
+            const Header* header = static_cast<const Header*>(base);
+            std::string error;
+            if (header->initialized_.load(std::memory_order_acquire) != 1) {
+                error = "queue is not initialized";
+            } else if (header->magic_ != MAGIC) {
+                error = "bad magic, not an ShmLFQueue";
+            } else if (header->version_ != VERSION) {
+                error = "layout version " + std::to_string(header->version_) +
+                    ", expected " + std::to_string(VERSION);
+            } else if (header->element_size_ != sizeof(T) || header->element_align_ != alignof(T)) {
+                error = "element size/alignment " + std::to_string(header->element_size_) + "/" +
+                    std::to_string(header->element_align_) + ", expected " +
+                    std::to_string(sizeof(T)) + "/" + std::to_string(alignof(T));
+            } else if (!is_pow2(header->capacity_) ||
+                       mapping_size(header->capacity_) != bytes) {
+                error = "capacity " + std::to_string(header->capacity_) +
+                    " does not match segment size " + std::to_string(bytes);
+            }
+            if (!error.empty()) {
+                report(name, error);
+                munmap(base, bytes);
+                close(fd);
+                return nullptr;
+            }
+            return std::unique_ptr<ShmLFQueue>(new ShmLFQueue(name, fd, base, bytes, false));
+        }
+
+        // producer process only
+        bool push(const T& obj) {
+            const size_t write_idx = header_->write_idx_.load(std::memory_order_relaxed);
+            if (write_idx - cached_read_idx_ >= capacity_) {
+                cached_read_idx_ = header_->read_idx_.load(std::memory_order_acquire);
+                if (write_idx - cached_read_idx_ >= capacity_) {
+                    return false;
+                }
+            }
+            std::memcpy(&slots_[write_idx & mask_], &obj, sizeof(T));
+            header_->write_idx_.store(write_idx + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer process only
+        std::optional<T> pop() {
+            const size_t read_idx = header_->read_idx_.load(std::memory_order_relaxed);
+            if (read_idx == cached_write_idx_) {
+                cached_write_idx_ = header_->write_idx_.load(std::memory_order_acquire);
+                if (read_idx == cached_write_idx_) {
+                    return std::nullopt;
+                }
+            }
+            std::optional<T> out(slots_[read_idx & mask_]);
+            header_->read_idx_.store(read_idx + 1, std::memory_order_release);
+            return out;
+        }
+
+        // approximate while the queue is in use
+        size_t size() const {
+            const size_t read_idx = header_->read_idx_.load(std::memory_order_acquire);
+            const size_t write_idx = header_->write_idx_.load(std::memory_order_acquire);
+            const size_t n = write_idx - read_idx;
+            return n < capacity_ ? n : capacity_;
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        const std::string& name() const {
+            return name_;
+        }
+    };
+}
@@ -0,0 +1,82 @@
+#include "asio_queue_reader.hpp"
+#include "eventfd_wait.hpp"
+#include "lock_free_queue.hpp"
+#include "wait_strategy.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using EventQueue = common::BlockingQueue<common::LFQueue<int>, common::EventFdWait>;
+
+TEST(EventFdWaitTest, SignalsOnlyArmedConsumer) {
+    EventQueue q(16);
+    // nobody is armed: pushes never touch the eventfd
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(q.try_push(i));
+    }
+    ASSERT_EQ(q.consumer_wait().signals(), 0u);
+
+    while (q.try_pop().has_value());
+    q.consumer_wait().arm();
+    // a burst after arming costs a single signal
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(q.try_push(i));
+    }
+    ASSERT_EQ(q.consumer_wait().signals(), 1u);
+}
+
+TEST(EventFdWaitTest, BlockingPopTwoThreads) {
+    constexpr int numIterations = 1e5;
+    EventQueue q(16);
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            q.push(i);
+        }
+    });
+    for (int i = 0; i < numIterations; ++i) {
+        ASSERT_EQ(q.pop(), i);
+    }
+    producer.join();
+}
+
+TEST(AsioQueueReaderTest, DrainsBurstsFromIoContext) {
+    constexpr int numBursts = 50;
+    constexpr int burstSize = 20;
+    EventQueue q(1024);
+    boost::asio::io_context ioc;
+    std::vector<int> received;
+
+    auto handler = [&](int&& v) {
+        received.push_back(v);
+        if (received.size() == numBursts * burstSize) {
+            ioc.stop();
+        }
+    };
+    auto reader = std::make_shared<common::AsioQueueReader<EventQueue, decltype(handler)>>(
+        ioc, q, handler, 8
+    );
+    reader->start();
+
+    std::thread producer([&]() {
+        for (int b = 0; b < numBursts; ++b) {
+            for (int i = 0; i < burstSize; ++i) {
+                while (!q.try_push(b * burstSize + i));
+            }
+            // let the io thread drain and go back to sleep
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    ioc.run();
+    producer.join();
+
+    ASSERT_EQ(received.size(), static_cast<size_t>(numBursts * burstSize));
+    for (int i = 0; i < numBursts * burstSize; ++i) {
+        ASSERT_EQ(received[i], i);
+    }
+    // at most one eventfd write per burst, not one per message
+    ASSERT_LE(q.consumer_wait().signals(), static_cast<uint64_t>(numBursts));
+    ASSERT_GE(reader->wakeups(), 1u);
+}
@@ -0,0 +1,108 @@
+#include "thread_utils.hpp"
+#include "broadcast_ring.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(BroadcastRingTest, EveryConsumerSeesEveryElement) {
+    common::BroadcastRing<int> ring(4);
+    auto& a = ring.add_consumer();
+    auto& b = ring.add_consumer();
+
+    ASSERT_EQ(a.peek(), nullptr);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.push(i));
+    }
+    ASSERT_FALSE(ring.push(4)); // both consumers are a full lap behind
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(*a.peek(), i);
+        a.consume();
+    }
+    ASSERT_EQ(a.peek(), nullptr);
+    // b still holds the oldest slot, so the producer is still gated
+    ASSERT_FALSE(ring.push(4));
+
+    ASSERT_EQ(b.poll([](const int&) {}, 2), 2u);
+    ASSERT_TRUE(ring.push(4));
+    ASSERT_TRUE(ring.push(5));
+    ASSERT_FALSE(ring.push(6));
+    ASSERT_EQ(*a.peek(), 4);
+    ASSERT_EQ(*b.peek(), 2);
+}
+
+TEST(BroadcastRingTest, DependentConsumerWaitsForUpstream) {
+    common::BroadcastRing<int> ring(8);
+    auto& book = ring.add_consumer();
+    auto& strategy = ring.add_consumer({&book});
+
+    ASSERT_TRUE(ring.push(1));
+    ASSERT_EQ(strategy.peek(), nullptr); // book has not processed it yet
+    ASSERT_EQ(*book.peek(), 1);
+    book.consume();
+    ASSERT_EQ(*strategy.peek(), 1);
+    strategy.consume();
+    ASSERT_EQ(strategy.sequence(), 1u);
+}
+
+struct Tick {
+    int64_t seq;
+    double price;
+};
+
+TEST(BroadcastRingTest, PipelineFourThreads) {
+    constexpr int numIterations = 1e6;
+    common::BroadcastRing<Tick> ring(64);
+    auto& book = ring.add_consumer();
+    auto& logger = ring.add_consumer();
+    auto& strategy = ring.add_consumer({&book});
+
+    // written by the book builder, read by the strategy without any
+    // synchronisation other than the dependency between the two cursors
+    std::vector<double> book_state(numIterations);
+    int64_t logged = 0, traded = 0;
+
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            Tick* slot;
+            while ((slot = ring.try_claim()) == nullptr);
+            slot->seq = i;
+            slot->price = i * 0.25;
+            ring.publish();
+        }
+    });
+    std::thread book_thread([&]() {
+        for (int64_t n = 0; n < numIterations;) {
+            n += book.poll([&](const Tick& t) { book_state[t.seq] = t.price; }, 16);
+        }
+    });
+    std::thread logger_thread([&]() {
+        while (logged < numIterations) {
+            const Tick* t = logger.peek();
+            if (t == nullptr) {
+                continue;
+            }
+            ASSERT_EQ(t->seq, logged);
+            ++logged;
+            logger.consume();
+        }
+    });
+    std::thread strategy_thread([&]() {
+        while (traded < numIterations) {
+            strategy.poll([&](const Tick& t) {
+                ASSERT_EQ(t.seq, traded);
+                ASSERT_EQ(book_state[t.seq], t.price);
+                ++traded;
+            }, 16);
+        }
+    });
+
+    producer.join();
+    book_thread.join();
+    logger_thread.join();
+    strategy_thread.join();
+    ASSERT_EQ(logged, numIterations);
+    ASSERT_EQ(traded, numIterations);
+    ASSERT_EQ(ring.sequence(), static_cast<size_t>(numIterations));
+}
@@ -0,0 +1,91 @@
+#include "thread_utils.hpp"
+#include "byte_ring.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <thread>
+
+static std::string_view as_string(std::span<const std::byte> record) {
+    return {reinterpret_cast<const char*>(record.data()), record.size()};
+}
+
+TEST(ByteRingTest, WriteReadOneThread) {
+    common::ByteRing ring(64);
+    ASSERT_TRUE(ring.peek().empty());
+    ASSERT_TRUE(ring.write("trade", 5));
+    ASSERT_TRUE(ring.write("l2update", 8));
+
+    ASSERT_EQ(as_string(ring.peek()), "trade");
+    ASSERT_EQ(as_string(ring.peek()), "trade"); // peek does not advance
+    ring.release();
+    ASSERT_EQ(as_string(ring.peek()), "l2update");
+    ring.release();
+    ASSERT_TRUE(ring.peek().empty());
+    ASSERT_EQ(ring.bytes_used(), 0u);
+}
+
+TEST(ByteRingTest, RecordsNeverSplitAcrossWrap) {
+    common::ByteRing ring(64);
+    ASSERT_EQ(ring.max_record_size(), 24u);
+    // 24-byte payload -> 32-byte records; a 20-byte payload leaves the ring
+    // offset at 28 so later records have to wrap
+    for (int i = 0; i < 50; ++i) {
+        const std::string payload(i % 2 ? 20 : 24, static_cast<char>('a' + i % 26));
+        ASSERT_TRUE(ring.write(payload.data(), payload.size()));
+        auto record = ring.peek();
+        ASSERT_EQ(as_string(record), payload);
+        ring.release();
+    }
+}
+
+TEST(ByteRingTest, ReserveCommitShorter) {
+    common::ByteRing ring(256);
+    std::byte* dst = ring.reserve(100);
+    ASSERT_NE(dst, nullptr);
+    std::memcpy(dst, "abc", 3);
+    ring.commit(3);
+    ASSERT_EQ(as_string(ring.peek()), "abc");
+    ring.release();
+}
+
+TEST(ByteRingTest, FullRing) {
+    common::ByteRing ring(64);
+    ASSERT_TRUE(ring.write("0123456789abcdef", 16)); // 24 bytes
+    ASSERT_TRUE(ring.write("0123456789abcdef", 16)); // 48
+    ASSERT_FALSE(ring.write("0123456789abcdef", 16)); // would need 72
+    ASSERT_TRUE(ring.write("01234567", 8)); // exactly 64
+    ASSERT_EQ(ring.reserve(0), nullptr);
+    ring.peek();
+    ring.release();
+    ASSERT_TRUE(ring.write("", 0));
+}
+
+TEST(ByteRingTest, VariableSizeTwoThreads) {
+    constexpr int numIterations = 1e6;
+    common::ByteRing ring(4096);
+
+    // frame i is i % 1500 bytes, every byte set to i
+    std::thread producer([&]() {
+        std::string frame;
+        for (int i = 0; i < numIterations; ++i) {
+            frame.assign(i % 1500, static_cast<char>(i));
+            while (!ring.write(frame.data(), frame.size()));
+        }
+    });
+    std::thread consumer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            std::span<const std::byte> record;
+            while ((record = ring.peek()).data() == nullptr);
+            ASSERT_EQ(record.size(), static_cast<size_t>(i % 1500));
+            for (std::byte b : record) {
+                ASSERT_EQ(static_cast<char>(b), static_cast<char>(i));
+            }
+            ring.release();
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    ASSERT_TRUE(ring.peek().empty());
+}
@@ -0,0 +1,118 @@
+#include "test_threads.hpp"
+#include "concurrent_mem_pool.hpp"
+#include "lock_free_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Order {
+    int64_t id_;
+    int64_t owner_;
+    std::string tag_;
+};
+
+TEST(ConcurrentMemPoolTest, AllocateDeallocateOneThread) {
+    common::ConcurrentMemPool<Order> pool(4);
+    std::set<Order*> blocks;
+    for (int i = 0; i < 4; ++i) {
+        Order* order = pool.allocate(Order{i, 0, "order"});
+        ASSERT_TRUE(pool.owns(order));
+        ASSERT_EQ(order->id_, i);
+        blocks.insert(order);
+    }
+    ASSERT_EQ(blocks.size(), 4u);
+    Order* last = *blocks.begin();
+    pool.deallocate(last);
+    // most recently freed block comes back first
+    ASSERT_EQ(pool.allocate(Order{9, 0, "again"}), last);
+
+    int outside = 0;
+    ASSERT_FALSE(pool.owns(reinterpret_cast<Order*>(&outside)));
+}
+
+TEST(ConcurrentMemPoolTest, DestroysLiveObjects) {
+    auto counter = std::make_shared<int>(0);
+    {
+        common::ConcurrentMemPool<std::shared_ptr<int>> pool(8);
+        auto* a = pool.allocate(counter);
+        pool.allocate(counter);
+        pool.deallocate(a);
+        ASSERT_EQ(counter.use_count(), 2);
+    }
+    ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(ConcurrentMemPoolDeathTest, ExhaustedAndDoubleFree) {
+    ASSERT_EXIT({
+        common::ConcurrentMemPool<int> pool(1);
+        pool.allocate(1);
+        pool.allocate(2);
+    }, ::testing::ExitedWithCode(EXIT_FAILURE), "ConcurrentMemPool is full");
+    ASSERT_EXIT({
+        common::ConcurrentMemPool<int> pool(2);
+        int* a = pool.allocate(1);
+        pool.deallocate(a);
+        pool.deallocate(a);
+    }, ::testing::ExitedWithCode(EXIT_FAILURE), "Expected in-use block");
+}
+
+// every thread allocates a batch, stamps it, checks nobody else stamped
+// the same blocks, and frees it again; a tight pool makes the head
+// change hands constantly
+void stressWork(common::ConcurrentMemPool<Order>& pool, int64_t owner, int numIterations) {
+    std::vector<Order*> held;
+    for (int i = 0; i < numIterations; ++i) {
+        const size_t batch = 1 + i % 8;
+        for (size_t j = 0; j < batch; ++j) {
+            held.push_back(pool.allocate(Order{i, owner, ""}));
+        }
+        for (Order* order : held) {
+            EXPECT_EQ(order->owner_, owner);
+            pool.deallocate(order);
+        }
+        held.clear();
+    }
+}
+
+TEST(ConcurrentMemPoolTest, StressManyThreads) {
+    constexpr int numThreads = 8;
+    constexpr int numIterations = 1e5;
+    common::ConcurrentMemPool<Order> pool(numThreads * 8);
+
+    test::ThreadGroup(numThreads, "stress", [&](int t) {
+        stressWork(pool, t, numIterations);
+    }).join();
+    // everything went back: the whole capacity can be taken again
+    for (int i = 0; i < numThreads * 8; ++i) {
+        pool.allocate(Order{i, -1, ""});
+    }
+}
+
+// allocate on the feed thread, free on the strategy thread
+TEST(ConcurrentMemPoolTest, AllocateHereFreeThere) {
+    constexpr int numIterations = 1e6;
+    common::ConcurrentMemPool<Order> pool(256);
+    common::LFQueue<Order*> queue(128);
+
+    std::thread strategy([&]() {
+        for (int64_t i = 0; i < numIterations; ++i) {
+            std::optional<Order*> order;
+            do {
+                order = queue.pop();
+            } while (!order.has_value());
+            ASSERT_EQ((*order)->id_, i);
+            ASSERT_EQ((*order)->tag_, std::to_string(i));
+            pool.deallocate(*order);
+        }
+    });
+    for (int64_t i = 0; i < numIterations; ++i) {
+        Order* order = pool.allocate(Order{i, 0, std::to_string(i)});
+        while (!queue.push(order));
+    }
+    strategy.join();
+}
@@ -0,0 +1,68 @@
+#include "dual_lane_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(DualLaneQueueTest, HighLaneFirstOneThread) {
+    common::DualLaneQueue<int> queue(4, 1000);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(queue.push(i));
+    }
+    ASSERT_FALSE(queue.push(1000));
+    // a full bulk lane does not block the high lane
+    ASSERT_TRUE(queue.push_high(-1));
+    ASSERT_TRUE(queue.push_high(-2));
+    ASSERT_EQ(queue.size(), 1002u);
+
+    ASSERT_EQ(queue.pop(), -1);
+    ASSERT_EQ(queue.pop(), -2);
+    ASSERT_EQ(queue.pop(), 0);
+    ASSERT_EQ(queue.pop(), 1);
+
+    // a high element pushed mid-drain is picked up before the next chunk
+    std::vector<int> seen;
+    queue.drain([&](int& v) {
+        seen.push_back(v);
+        if (v == 5) {
+            queue.push_high(-3);
+        }
+    }, 40);
+    ASSERT_EQ(seen.size(), 40u);
+    ASSERT_EQ(seen[16], -3);
+    for (size_t i = 0; i < 16; ++i) {
+        ASSERT_EQ(seen[i], static_cast<int>(i) + 2);
+    }
+    ASSERT_EQ(seen[17], 18);
+    ASSERT_EQ(queue.high_size(), 0u);
+    ASSERT_FALSE(queue.empty());
+}
+
+TEST(DualLaneQueueTest, FifoPerLaneTwoThreads) {
+    constexpr int numIterations = 1e6;
+    common::DualLaneQueue<int> queue(16, 1024);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            while (!queue.push(i));
+            if (i % 1000 == 0) {
+                while (!queue.push_high(-(i / 1000) - 1));
+            }
+        }
+    });
+
+    int next_bulk = 0;
+    int next_high = -1;
+    const int num_high = (numIterations - 1) / 1000 + 1;
+    while (next_bulk < numIterations || next_high >= -num_high) {
+        queue.drain([&](int& v) {
+            if (v < 0) {
+                ASSERT_EQ(v, next_high--);
+            } else {
+                ASSERT_EQ(v, next_bulk++);
+            }
+        }, 64);
+    }
+    producer.join();
+    ASSERT_TRUE(queue.empty());
+}
@@ -0,0 +1,160 @@
+#include "growable_mem_pool.hpp"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Order {
+    int64_t id_;
+    std::string tag_;
+};
+
+static void wait_for_spare(const common::GrowableMemPool<Order>& pool) {
+    while (!pool.spare_ready()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST(GrowableMemPoolTest, AddressesStableAcrossGrowth) {
+    common::GrowableMemPool<Order> pool(4, 10);
+    ASSERT_EQ(pool.capacity(), 4u);
+    ASSERT_EQ(pool.max_slabs(), 10u);
+
+    std::vector<Order*> orders;
+    for (int i = 0; i < 40; ++i) {
+        orders.push_back(pool.allocate(Order{i, "order " + std::to_string(i)}));
+    }
+    ASSERT_EQ(pool.size(), 40u);
+    ASSERT_EQ(pool.slabs(), 10u);
+    ASSERT_EQ(pool.capacity(), 40u);
+    ASSERT_EQ(pool.slab_grows(), 9u);
+
+    // growing never moved an earlier object
+    std::set<Order*> distinct(orders.begin(), orders.end());
+    ASSERT_EQ(distinct.size(), orders.size());
+    for (int i = 0; i < 40; ++i) {
+        ASSERT_TRUE(pool.owns(orders[i]));
+        ASSERT_EQ(orders[i]->id_, i);
+        ASSERT_EQ(orders[i]->tag_, "order " + std::to_string(i));
+    }
+
+    int outside = 0;
+    ASSERT_FALSE(pool.owns(reinterpret_cast<Order*>(&outside)));
+}
+
+TEST(GrowableMemPoolTest, ReusesFreedBlocksBeforeGrowing) {
+    common::GrowableMemPool<Order> pool(4);
+    std::vector<Order*> orders;
+    for (int i = 0; i < 12; ++i) {
+        orders.push_back(pool.allocate(Order{i, "order"}));
+    }
+    const size_t grows = pool.slab_grows();
+    for (Order* order : orders) {
+        pool.deallocate(order);
+    }
+    ASSERT_EQ(pool.size(), 0u);
+
+    // blocks of every slab are reusable, most recently freed first
+    ASSERT_EQ(pool.allocate(Order{100, "again"}), orders.back());
+    for (int i = 1; i < 12; ++i) {
+        pool.allocate(Order{100 + i, "again"});
+    }
+    ASSERT_EQ(pool.slab_grows(), grows);
+    ASSERT_EQ(pool.capacity(), 12u);
+}
+
+TEST(GrowableMemPoolTest, GrowsFromPreallocatedSpare) {
+    common::GrowableMemPool<Order> pool(64);
+    for (int round = 0; round < 4; ++round) {
+        // what an idle gap between bursts gives the pre-allocator
+        wait_for_spare(pool);
+        for (int i = 0; i < 64; ++i) {
+            pool.allocate(Order{i, "burst"});
+        }
+    }
+    // the first burst fits the initial slab, each later one splices a spare
+    ASSERT_EQ(pool.slab_grows(), 3u);
+    ASSERT_EQ(pool.sync_grows(), 0u);
+    ASSERT_EQ(pool.size(), 256u);
+}
+
+TEST(GrowableMemPoolTest, BurstOutrunsPreallocator) {
+    common::GrowableMemPool<Order> pool(2);
+    for (int i = 0; i < 1000; ++i) {
+        pool.allocate(Order{i, "burst"});
+    }
+    // never fails; whatever the pre-allocator could not keep up with was
+    // built inline
+    ASSERT_EQ(pool.size(), 1000u);
+    ASSERT_EQ(pool.slab_grows(), 499u);
+    ASSERT_LE(pool.sync_grows(), pool.slab_grows());
+}
+
+TEST(GrowableMemPoolTest, DestroysLiveObjects) {
+    auto counter = std::make_shared<int>(0);
+    {
+        common::GrowableMemPool<std::shared_ptr<int>> pool(2);
+        auto* a = pool.allocate(counter);
+        pool.allocate(counter);
+        pool.allocate(counter);
+        pool.deallocate(a);
+        ASSERT_EQ(counter.use_count(), 3);
+    }
+    ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(GrowableMemPoolDeathTest, DoubleFreeAndForeignPointer) {
+    ASSERT_EXIT({
+        common::GrowableMemPool<int> pool(2);
+        pool.allocate(1);
+        pool.allocate(2);
+        int* a = pool.allocate(3);
+        pool.deallocate(a);
+        pool.deallocate(a);
+    }, ::testing::ExitedWithCode(EXIT_FAILURE), "Expected in-use");
+    ASSERT_EXIT({
+        common::GrowableMemPool<int> pool(2);
+        int outside = 0;
+        pool.deallocate(&outside);
+    }, ::testing::ExitedWithCode(EXIT_FAILURE), "does not belong");
+    // inside a grown slab, but not at the start of a block
+    ASSERT_EXIT({
+        common::GrowableMemPool<int> pool(2);
+        int* a = nullptr;
+        for (int i = 0; i < 5; ++i) {
+            a = pool.allocate(i);
+        }
+        pool.deallocate(reinterpret_cast<int*>(reinterpret_cast<char*>(a) + 1));
+    }, ::testing::ExitedWithCode(EXIT_FAILURE), "does not belong");
+}
+
+TEST(GrowableMemPoolTest, OwnsAcrossManySlabs) {
+    common::GrowableMemPool<Order> pool(3, 200);
+    std::vector<Order*> orders;
+    for (int i = 0; i < 600; ++i) {
+        orders.push_back(pool.allocate(Order{i, ""}));
+    }
+    for (Order* order : orders) {
+        ASSERT_TRUE(pool.owns(order));
+        ASSERT_FALSE(pool.owns(reinterpret_cast<Order*>(reinterpret_cast<char*>(order) + 8)));
+    }
+    Order outside{0, ""};
+    ASSERT_FALSE(pool.owns(&outside));
+    for (Order* order : orders) {
+        pool.deallocate(order);
+    }
+    ASSERT_EQ(pool.size(), 0u);
+}
+
+TEST(GrowableMemPoolDeathTest, SlabLimit) {
+    ASSERT_EXIT({
+        common::GrowableMemPool<int> pool(2, 3);
+        for (int i = 0; i < 7; ++i) {
+            pool.allocate(i);
+        }
+    }, ::testing::ExitedWithCode(EXIT_FAILURE), "reached its 3 slabs");
+}
@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include <iostream>
+#include <stdexcept>
 
 
 template<typename T>
@@ -68,6 +69,241 @@ TEST_F(IntLFQueueTest, PushPopTwoThreads) {
     ASSERT_EQ(pushedValues, poppedValues);
 }
 
+TEST_F(IntLFQueueTest, SizeFromCursorsOneThread) {
+    // push and pop across the wrap point of the ring
+    for (int i = 0; i < 25; ++i) {
+        ASSERT_TRUE(queue.push(i));
+        ASSERT_TRUE(queue.push(i));
+        ASSERT_EQ(queue.size(), 2);
+        queue.pop();
+        queue.pop();
+        ASSERT_EQ(queue.size(), 0);
+    }
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(queue.push(i));
+        ASSERT_EQ(queue.size(), static_cast<size_t>(i + 1));
+    }
+}
+
+TEST(ExactSizeLFQueueTest, SizeTwoThreads) {
+    constexpr int numIterations = 1e6;
+    common::LFQueue<int, true> q(10);
+
+    // the exact counter stays in [0, capacity] for every thread; a 
+    // negative count would show up as a huge size_t
+    std::atomic<bool> done{false};
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            while (!q.push(i));
+            ASSERT_LE(q.size(), 10);
+        }
+    });
+    std::thread consumer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            std::optional<int> val;
+            do {
+                val = q.pop();
+            } while (!val.has_value());
+            ASSERT_LE(q.size(), 10);
+        }
+    });
+    std::thread observer([&]() {
+        while (!done.load(std::memory_order_acquire)) {
+            ASSERT_LE(q.size(), 10);
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    done.store(true, std::memory_order_release);
+    observer.join();
+    ASSERT_EQ(q.size(), 0);
+}
+
+TEST_F(IntLFQueueTest, TwoPhaseOneThread) {
+    ASSERT_EQ(queue.peek(), nullptr);
+    for (int i = 0; i < 10; ++i) {
+        int* slot = queue.get_next_to_write();
+        ASSERT_NE(slot, nullptr);
+        *slot = i;
+        queue.commit_write();
+    }
+    ASSERT_EQ(queue.get_next_to_write(), nullptr); // full
+    for (int i = 0; i < 10; ++i) {
+        const int* val = queue.peek();
+        ASSERT_NE(val, nullptr);
+        ASSERT_EQ(*val, i);
+        ASSERT_EQ(queue.peek(), val); // peek does not advance
+        queue.consume();
+    }
+    ASSERT_EQ(queue.peek(), nullptr);
+}
+
+// market data sized event, decoded straight into the ring slot
+struct alignas(64) TestEvent {
+    int64_t seq;
+    double price;
+    double qty;
+    char product[40];
+};
+
+TEST(TwoPhaseLFQueueTest, InPlaceTwoThreads) {
+    constexpr int numIterations = 1e6;
+    common::LFQueue<TestEvent> q(64);
+    std::vector<int64_t> seen(numIterations);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            TestEvent* slot;
+            while ((slot = q.get_next_to_write()) == nullptr);
+            slot->seq = i;
+            slot->price = i * 0.5;
+            slot->qty = 1.0;
+            q.commit_write();
+        }
+    });
+    std::thread consumer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            const TestEvent* ev;
+            while ((ev = q.peek()) == nullptr);
+            ASSERT_EQ(ev->price, ev->seq * 0.5);
+            seen[i] = ev->seq;
+            q.consume();
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    for (int i = 0; i < numIterations; ++i) {
+        ASSERT_EQ(seen[i], i);
+    }
+}
+
+TEST_F(IntLFQueueTest, BatchWrapsOneThread) {
+    int in[7];
+    int out[10];
+    int next_in = 0, next_out = 0;
+    // 7-element batches into a 10-slot ring wrap on every other pass
+    for (int pass = 0; pass < 20; ++pass) {
+        for (int& v : in) {
+            v = next_in++;
+        }
+        ASSERT_EQ(queue.push_n(in, 7), 7u);
+        ASSERT_EQ(queue.size(), 7u);
+        ASSERT_EQ(queue.pop_n(out, 10), 7u);
+        for (int i = 0; i < 7; ++i) {
+            ASSERT_EQ(out[i], next_out++);
+        }
+    }
+    // a batch larger than the free space is truncated
+    int big[12] = {};
+    ASSERT_EQ(queue.push_n(big, 12), 10u);
+    ASSERT_EQ(queue.push_n(big, 1), 0u);
+    ASSERT_EQ(queue.drain([](int&) {}, 4), 4u);
+    ASSERT_EQ(queue.size(), 6u);
+}
+
+TEST(BatchLFQueueTest, DrainTwoThreads) {
+    constexpr int numIterations = 1e6;
+    constexpr int batch = 16;
+    // non-trivially copyable, exercises the element-wise path
+    common::LFQueue<std::string> q(100);
+    std::vector<std::string> received;
+    received.reserve(numIterations);
+
+    std::thread producer([&]() {
+        std::string buf[batch];
+        for (int i = 0; i < numIterations; i += batch) {
+            for (int j = 0; j < batch; ++j) {
+                buf[j] = std::to_string(i + j);
+            }
+            size_t pushed = 0;
+            while (pushed < batch) {
+                pushed += q.push_n(buf + pushed, batch - pushed);
+            }
+        }
+    });
+    std::thread consumer([&]() {
+        while (received.size() < static_cast<size_t>(numIterations)) {
+            q.drain([&](std::string& s) { received.push_back(std::move(s)); }, batch);
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    for (int i = 0; i < numIterations; ++i) {
+        ASSERT_EQ(received[i], std::to_string(i));
+    }
+}
+
+// no default constructor, counts live instances
+struct Tracked {
+    static inline int live = 0;
+    int value;
+    explicit Tracked(int v) : value(v) { ++live; }
+    Tracked(const Tracked& other) : value(other.value) { ++live; }
+    Tracked(Tracked&& other) : value(other.value) { ++live; }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) = default;
+    ~Tracked() { --live; }
+};
+
+TEST(RawStorageLFQueueTest, NonDefaultConstructible) {
+    Tracked::live = 0;
+    {
+        common::LFQueue<Tracked> q(4);
+        common::FixedLFQueue<Tracked, 4> fq;
+        ASSERT_EQ(Tracked::live, 0); // no slot is constructed up front
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(q.push(Tracked(i)));
+            ASSERT_TRUE(fq.push(Tracked(i)));
+        }
+        ASSERT_EQ(Tracked::live, 6);
+        {
+            auto val = q.pop();
+            ASSERT_EQ(val->value, 0);
+        }
+        ASSERT_EQ(Tracked::live, 5); // popped slot was destroyed
+        Tracked out[2] = {Tracked(-1), Tracked(-1)};
+        ASSERT_EQ(q.pop_n(out, 1), 1u);
+        ASSERT_EQ(out[0].value, 1);
+        ASSERT_EQ(Tracked::live, 6);
+    }
+    // remaining elements are destroyed with the queue
+    ASSERT_EQ(Tracked::live, 0);
+}
+
+TEST(RawStorageLFQueueTest, DrainCallbackThrows) {
+    {
+        common::LFQueue<Tracked> q(8);
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(q.push(Tracked(i)));
+        }
+        ASSERT_THROW(q.drain([](Tracked& t) {
+            if (t.value == 2) {
+                throw std::runtime_error("handler failed");
+            }
+        }, 5), std::runtime_error);
+        // the two finished elements are released exactly once, the one
+        // the callback threw on is still first in line
+        ASSERT_EQ(Tracked::live, 3);
+        ASSERT_EQ(q.size(), 3u);
+        ASSERT_EQ(q.pop().value().value, 2);
+    }
+    ASSERT_EQ(Tracked::live, 0);
+}
+
+TEST(RawStorageLFQueueTest, MoveOnly) {
+    common::LFQueue<std::unique_ptr<int>> q(4);
+    common::FixedLFQueue<std::unique_ptr<int>, 4> fq;
+    ASSERT_TRUE(q.push(std::make_unique<int>(7)));
+    ASSERT_TRUE(fq.push(std::make_unique<int>(8)));
+    ASSERT_EQ(*q.pop().value(), 7);
+    ASSERT_EQ(*fq.pop().value(), 8);
+    ASSERT_TRUE(q.push(std::make_unique<int>(9)));
+    q.drain([](std::unique_ptr<int>& p) { ASSERT_EQ(*p, 9); }, 1);
+}
+
 // INTEGRATION TEST
 // Function to be run by the producer thread
 void producerWork(common::LFQueue<int>& q, int numIterations) {
@@ -110,4 +346,81 @@ TEST_F(IntLFQueueTest, PushPopTwoCustomThreads) {
     for (int i = 0; i < numIterations; ++i) {
         ASSERT_EQ(poppedValues[i], i);
     }
+}
+
+// FIXED CAPACITY QUEUE
+TEST(FixedLFQueueTest, PushPopOneThread) {
+    common::FixedLFQueue<int, 8> q;
+    ASSERT_TRUE(q.push(1));
+    ASSERT_EQ(q.size(), 1);
+    auto result = q.pop();
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(result.value(), 1);
+    ASSERT_FALSE(q.pop().has_value());
+}
+
+TEST(FixedLFQueueTest, PushToFullQueueWrapsAround) {
+    common::FixedLFQueue<int, 8> q;
+    // several laps so the cursors wrap past the mask
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 8; ++i) {
+            ASSERT_TRUE(q.push(lap * 8 + i));
+        }
+        ASSERT_FALSE(q.push(-1)); // full at exactly N elements
+        ASSERT_EQ(q.size(), 8);
+        for (int i = 0; i < 8; ++i) {
+            ASSERT_EQ(q.pop().value(), lap * 8 + i);
+        }
+        ASSERT_EQ(q.size(), 0);
+    }
+}
+
+TEST(FixedLFQueueTest, PushPopTwoThreadsInOrder) {
+    constexpr int numIterations = 1e6;
+    auto q = std::make_unique<common::FixedLFQueue<int, 64>>();
+    std::vector<int> poppedValues(numIterations);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            while (!q->push(i));
+        }
+    });
+    std::thread consumer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            std::optional<int> val;
+            do {
+                val = q->pop();
+            } while (!val.has_value());
+            poppedValues[i] = val.value();
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    // single producer/single consumer: FIFO order is preserved exactly
+    for (int i = 0; i < numIterations; ++i) {
+        ASSERT_EQ(poppedValues[i], i);
+    }
+}
+
+
+TEST(FixedLFQueueTest, TwoPhaseOneThread) {
+    common::FixedLFQueue<int, 4> q;
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 4; ++i) {
+            int* slot = q.get_next_to_write();
+            ASSERT_NE(slot, nullptr);
+            *slot = lap * 4 + i;
+            q.commit_write();
+        }
+        ASSERT_EQ(q.get_next_to_write(), nullptr);
+        for (int i = 0; i < 4; ++i) {
+            const int* val = q.peek();
+            ASSERT_NE(val, nullptr);
+            ASSERT_EQ(*val, lap * 4 + i);
+            q.consume();
+        }
+        ASSERT_EQ(q.peek(), nullptr);
+    }
 }
\ No newline at end of file
@@ -9,8 +9,9 @@ int main() {
         char b;
     };
 
-    common::MemPool<Example> example_pool(4);
-    common::MemPool<double> double_pool(2);
+    // traced, so every allocation and deallocation is printed
+    common::MemPool<Example, common::TracedPool> example_pool(4);
+    common::MemPool<double, common::TracedPool> double_pool(2);
 
     double* da = double_pool.allocate(1.0);
     double* db =double_pool.allocate(2.0);
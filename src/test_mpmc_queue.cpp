@@ -0,0 +1,84 @@
+#include "test_threads.hpp"
+#include "mpmc_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST(MPMCQueueTest, PushPopOneThread) {
+    common::MPMCQueue<int> q(10);
+    ASSERT_EQ(q.capacity(), 16u);
+    ASSERT_FALSE(q.pop().has_value());
+    // several laps so slot sequences advance past the first round
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 16; ++i) {
+            ASSERT_TRUE(q.push(i));
+        }
+        ASSERT_FALSE(q.push(-1));
+        ASSERT_EQ(q.size(), 16u);
+        for (int i = 0; i < 16; ++i) {
+            ASSERT_EQ(q.pop().value(), i);
+        }
+        ASSERT_FALSE(q.pop().has_value());
+        ASSERT_EQ(q.size(), 0u);
+    }
+}
+
+TEST(MPMCQueueTest, MoveOnly) {
+    common::MPMCQueue<std::unique_ptr<int>> q(4);
+    ASSERT_TRUE(q.push(std::make_unique<int>(5)));
+    ASSERT_TRUE(q.push(std::make_unique<int>(6))); // left for the destructor
+    ASSERT_EQ(*q.pop().value(), 5);
+}
+
+// producers tag values with their id, as in test_mpsc_queue.cpp
+void mpmcProducerWork(common::MPMCQueue<int64_t>& q, int64_t id, int numIterations) {
+    for (int64_t i = 0; i < numIterations; ++i) {
+        while (!q.push((id << 32) | i));
+    }
+}
+
+TEST(MPMCQueueTest, ManyProducersManyConsumers) {
+    constexpr int numProducers = 4;
+    constexpr int numConsumers = 4;
+    constexpr int numIterations = 1e6;
+    common::MPMCQueue<int64_t> q(64);
+
+    test::ThreadGroup producers(numProducers, "producer", [&](int p) {
+        mpmcProducerWork(q, p, numIterations);
+    });
+
+    // every value is received exactly once, and any one consumer sees
+    // each producer's values in the order they were pushed
+    std::vector<std::atomic<int>> seen(numProducers * numIterations);
+    std::atomic<int64_t> received{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < numConsumers; ++c) {
+        consumers.emplace_back([&]() {
+            std::vector<int64_t> last(numProducers, -1);
+            while (received.load(std::memory_order_relaxed) < numProducers * numIterations) {
+                auto val = q.pop();
+                if (!val.has_value()) {
+                    continue;
+                }
+                const int64_t id = val.value() >> 32;
+                const int64_t seq = val.value() & 0xffffffff;
+                EXPECT_GT(seq, last[id]);
+                last[id] = seq;
+                seen[id * numIterations + seq].fetch_add(1, std::memory_order_relaxed);
+                received.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    producers.join();
+    for (auto& t : consumers) {
+        t.join();
+    }
+    for (const auto& count : seen) {
+        ASSERT_EQ(count.load(), 1);
+    }
+    ASSERT_FALSE(q.pop().has_value());
+}
@@ -0,0 +1,77 @@
+#include "test_threads.hpp"
+#include "mpsc_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(MPSCQueueTest, PushPopOneThread) {
+    common::MPSCQueue<int> q(8);
+    ASSERT_FALSE(q.pop().has_value());
+    ASSERT_TRUE(q.push(1));
+    auto result = q.pop();
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(result.value(), 1);
+    ASSERT_FALSE(q.pop().has_value());
+}
+
+TEST(MPSCQueueTest, CapacityRoundsUpToPowerOfTwo) {
+    common::MPSCQueue<int> q(10);
+    ASSERT_EQ(q.capacity(), 16u);
+    // several laps so slot sequences advance past the first round
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 16; ++i) {
+            ASSERT_TRUE(q.push(i));
+        }
+        ASSERT_FALSE(q.push(-1));
+        ASSERT_EQ(q.size(), 16u);
+        for (int i = 0; i < 16; ++i) {
+            ASSERT_EQ(q.pop().value(), i);
+        }
+        ASSERT_EQ(q.size(), 0u);
+    }
+}
+
+TEST(MPSCQueueTest, MoveOnly) {
+    common::MPSCQueue<std::unique_ptr<int>> q(4);
+    ASSERT_TRUE(q.push(std::make_unique<int>(5)));
+    ASSERT_TRUE(q.push(std::make_unique<int>(6))); // left for the destructor
+    ASSERT_EQ(*q.pop().value(), 5);
+}
+
+// each producer tags values with its id so per-producer order can be checked
+void mpscProducerWork(common::MPSCQueue<int64_t>& q, int64_t id, int numIterations) {
+    for (int64_t i = 0; i < numIterations; ++i) {
+        while (!q.push((id << 32) | i));
+    }
+}
+
+TEST(MPSCQueueTest, ManyProducersOneConsumer) {
+    constexpr int numProducers = 4;
+    constexpr int numIterations = 1e6;
+    common::MPSCQueue<int64_t> q(64);
+
+    test::ThreadGroup producers(numProducers, "producer", [&](int p) {
+        mpscProducerWork(q, p, numIterations);
+    });
+
+    // values from any single producer must arrive in the order it pushed them
+    std::vector<int64_t> next(numProducers, 0);
+    for (int64_t received = 0; received < numProducers * numIterations;) {
+        auto val = q.pop();
+        if (!val.has_value()) {
+            continue;
+        }
+        const int64_t id = val.value() >> 32;
+        const int64_t seq = val.value() & 0xffffffff;
+        ASSERT_EQ(seq, next[id]);
+        ++next[id];
+        ++received;
+    }
+
+    producers.join();
+    for (int p = 0; p < numProducers; ++p) {
+        ASSERT_EQ(next[p], numIterations);
+    }
+    ASSERT_FALSE(q.pop().has_value());
+}
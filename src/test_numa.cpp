@@ -0,0 +1,71 @@
+#include "thread_utils.hpp"
+#include "numa.hpp"
+#include "lock_free_queue.hpp"
+#include "mem_pool.hpp"
+#include "page_alloc.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+// placement is only checked where the kernel reports it; machines (or
+// sandboxes) without NUMA information skip
+
+TEST(NumaTest, CpuNodes) {
+    ASSERT_EQ(common::numa_node_of_cpu(-1), -1);
+    ASSERT_EQ(common::numa_node_of_cpu(1 << 20), -1);
+    ASSERT_EQ(common::numa_node_of_current_cpu(), common::numa_node_of_cpu(sched_getcpu()));
+}
+
+TEST(NumaTest, BoundBufferLandsOnNode) {
+    const int node = common::numa_node_of_cpu(0);
+    if (node < 0) {
+        GTEST_SKIP() << "no NUMA information for cpu 0";
+    }
+    common::PageBuffer buffer(1 << 20, common::PageSize::Default, 64, node);
+    // faulted in at construction, so the node is known right away
+    ASSERT_EQ(buffer.numa_node(), node);
+    ASSERT_EQ(common::numa_node_of_address(static_cast<char*>(buffer.data()) + (1 << 20) - 1), node);
+    ASSERT_TRUE(common::check_numa_placement("buffer", buffer.data(), 0));
+    ASSERT_TRUE(common::check_numa_node("buffer", buffer.data(), node));
+    // a node the memory is not on is reported
+    ASSERT_FALSE(common::check_numa_node("buffer", buffer.data(), node + 1));
+}
+
+TEST(NumaTest, QueueAndPoolBoundToNode) {
+    const int node = common::numa_node_of_cpu(0);
+    if (node < 0) {
+        GTEST_SKIP() << "no NUMA information for cpu 0";
+    }
+    common::LFQueue<int> queue(1 << 16, common::PageSize::Default, node);
+    common::MemPool<int> pool(1024, common::PageSize::Default, node);
+    ASSERT_EQ(queue.numa_node(), node);
+    ASSERT_EQ(pool.numa_node(), node);
+    for (int lap = 0; lap < 2; ++lap) {
+        for (int i = 0; i < (1 << 16); ++i) {
+            ASSERT_TRUE(queue.push(i));
+        }
+        for (int i = 0; i < (1 << 16); ++i) {
+            ASSERT_EQ(queue.pop(), i);
+        }
+    }
+    ASSERT_EQ(queue.numa_node(), node);
+}
+
+void firstTouchWork(common::LFQueue<int>& queue, int& touched_node) {
+    queue.first_touch();
+    touched_node = common::numa_node_of_current_cpu();
+}
+
+TEST(NumaTest, FirstTouchOnPinnedThread) {
+    if (common::numa_node_of_cpu(0) < 0) {
+        GTEST_SKIP() << "no NUMA information for cpu 0";
+    }
+    common::LFQueue<int> queue(1 << 16);
+
+    int touched_node = -2;
+    std::thread* t = common::create_and_start_thread(0, "consumer", firstTouchWork, queue, touched_node);
+    t->join();
+    delete t;
+    ASSERT_EQ(touched_node, common::numa_node_of_cpu(0));
+    ASSERT_EQ(queue.numa_node(), touched_node);
+}
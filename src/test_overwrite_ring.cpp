@@ -0,0 +1,135 @@
+#include "overwrite_ring.hpp"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+struct Ticker {
+    int64_t seq;
+    double bid;
+    double ask;
+    double last;
+};
+
+static Ticker make_ticker(int64_t i) {
+    return Ticker{i, i * 1.0, i * 1.0 + 0.5, i * 1.0 + 0.25};
+}
+
+TEST(OverwriteRingTest, ReadInOrderWithoutLapping) {
+    common::OverwriteRing<Ticker> ring(8);
+    auto reader = ring.reader();
+    ASSERT_FALSE(reader.read().has_value());
+    for (int i = 0; i < 5; ++i) {
+        ring.push(make_ticker(i));
+    }
+    for (int i = 0; i < 5; ++i) {
+        auto t = reader.read();
+        ASSERT_TRUE(t.has_value());
+        ASSERT_EQ(t->seq, i);
+    }
+    ASSERT_FALSE(reader.read().has_value());
+    ASSERT_EQ(reader.skipped(), 0u);
+}
+
+TEST(OverwriteRingTest, LappedReaderJumpsToLatest) {
+    common::OverwriteRing<Ticker> ring(4);
+    auto reader = ring.reader();
+    // producer never blocks, even with a reader that has not read anything
+    for (int i = 0; i < 10; ++i) {
+        ring.push(make_ticker(i));
+    }
+    auto t = reader.read();
+    ASSERT_TRUE(t.has_value());
+    ASSERT_EQ(t->seq, 9);
+    ASSERT_EQ(reader.last_skipped(), 9u);
+    ASSERT_FALSE(reader.read().has_value());
+
+    ring.push(make_ticker(10));
+    ASSERT_EQ(reader.read()->seq, 10);
+    ASSERT_EQ(reader.last_skipped(), 0u);
+    ASSERT_EQ(reader.skipped(), 9u);
+}
+
+TEST(OverwriteRingTest, ReadLatest) {
+    common::OverwriteRing<Ticker> ring(16);
+    auto reader = ring.reader();
+    for (int i = 0; i < 3; ++i) {
+        ring.push(make_ticker(i));
+    }
+    ASSERT_EQ(reader.read_latest()->seq, 2);
+    ASSERT_EQ(reader.last_skipped(), 2u);
+    ASSERT_FALSE(reader.read_latest().has_value());
+}
+
+TEST(OverwriteRingTest, SlowReadersNeverSeeTornValues) {
+    constexpr int numIterations = 1e6;
+    constexpr int numReaders = 2;
+    common::OverwriteRing<Ticker> ring(8);
+    std::vector<common::OverwriteRing<Ticker>::Reader> readers;
+    for (int r = 0; r < numReaders; ++r) {
+        readers.push_back(ring.reader());
+    }
+
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            ring.push(make_ticker(i));
+        }
+    });
+    std::vector<std::thread> consumers;
+    for (int r = 0; r < numReaders; ++r) {
+        consumers.emplace_back([&, r]() {
+            auto& reader = readers[r];
+            int64_t expected = 0;
+            while (expected < numIterations) {
+                auto t = reader.read();
+                if (!t.has_value()) {
+                    continue;
+                }
+                // gaps are allowed, but only the ones we were told about
+                ASSERT_EQ(t->seq, expected + static_cast<int64_t>(reader.last_skipped()));
+                ASSERT_EQ(t->ask, t->seq * 1.0 + 0.5);
+                ASSERT_EQ(t->last, t->seq * 1.0 + 0.25);
+                expected = t->seq + 1;
+            }
+        });
+    }
+
+    producer.join();
+    for (auto& c : consumers) {
+        c.join();
+    }
+}
+
+TEST(OverwriteRingTest, LappedMidCopyStaysBounded) {
+    constexpr int numIterations = 1e6;
+    // two slots: the producer laps the reader in the middle of most copies
+    common::OverwriteRing<Ticker> ring(2);
+    auto reader = ring.reader();
+
+    std::atomic<bool> done{false};
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            ring.push(make_ticker(i));
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    int64_t last = -1;
+    size_t reads = 0;
+    while (!done.load(std::memory_order_acquire) || last < numIterations - 1) {
+        auto t = reader.read();
+        // never more skipped than was ever published, and never backwards
+        ASSERT_LE(reader.skipped(), ring.sequence());
+        if (!t.has_value()) {
+            continue;
+        }
+        ASSERT_GT(t->seq, last);
+        ASSERT_EQ(t->last, t->seq * 1.0 + 0.25);
+        last = t->seq;
+        ++reads;
+    }
+    producer.join();
+    // every entry was either read or counted as skipped, exactly once
+    ASSERT_EQ(reads + reader.skipped(), static_cast<size_t>(numIterations));
+}
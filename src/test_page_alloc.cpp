@@ -0,0 +1,66 @@
+#include "page_alloc.hpp"
+#include "lock_free_queue.hpp"
+#include "mem_pool.hpp"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+
+// whether huge pages are reserved depends on the machine, so these only
+// check that every request ends up with usable memory and says what it got
+
+static bool is_aligned(const void* p, size_t to) {
+    return reinterpret_cast<uintptr_t>(p) % to == 0;
+}
+
+TEST(PageBufferTest, DefaultIsHeap) {
+    common::PageBuffer buf(1000, common::PageSize::Default);
+    ASSERT_EQ(buf.obtained(), common::PageKind::Default);
+    ASSERT_TRUE(is_aligned(buf.data(), 64));
+    ASSERT_EQ(buf.bytes(), 1000u);
+    std::memset(buf.data(), 0xab, buf.bytes());
+}
+
+TEST(PageBufferTest, HugeRequestsFallBack) {
+    for (auto want : {common::PageSize::Huge2M, common::PageSize::Huge1G}) {
+        common::PageBuffer buf(3 * common::PageBuffer::SIZE_2M + 5, want);
+        switch (buf.obtained()) {
+            case common::PageKind::Huge1G:
+                ASSERT_EQ(want, common::PageSize::Huge1G);
+                ASSERT_TRUE(is_aligned(buf.data(), common::PageBuffer::SIZE_1G));
+                break;
+            case common::PageKind::Huge2M:
+            case common::PageKind::TransparentHuge:
+                ASSERT_TRUE(is_aligned(buf.data(), common::PageBuffer::SIZE_2M));
+                break;
+            case common::PageKind::Default:
+                ASSERT_TRUE(is_aligned(buf.data(), 64));
+                break;
+        }
+        std::memset(buf.data(), 0xab, buf.bytes());
+    }
+}
+
+TEST(PageBufferTest, HonoursLargeAlignment) {
+    common::PageBuffer buf(512, common::PageSize::Default, 256);
+    ASSERT_TRUE(is_aligned(buf.data(), 256));
+}
+
+TEST(PageBufferTest, QueueAndPoolOnHugePages) {
+    common::LFQueue<int64_t> queue(1 << 20, common::PageSize::Huge2M);
+    ASSERT_NE(queue.page_kind(), common::PageKind::Huge1G);
+    for (int64_t i = 0; i < (1 << 20); ++i) {
+        ASSERT_TRUE(queue.push(i));
+    }
+    for (int64_t i = 0; i < (1 << 20); ++i) {
+        ASSERT_EQ(queue.pop(), i);
+    }
+
+    common::MemPool<int64_t> pool(4, common::PageSize::Huge2M);
+    ASSERT_NE(pool.page_kind(), common::PageKind::Huge1G);
+    int64_t* a = pool.allocate(1);
+    int64_t* b = pool.allocate(2);
+    ASSERT_EQ(*a + *b, 3);
+    pool.deallocate(a);
+    pool.deallocate(b);
+}
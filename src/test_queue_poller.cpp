@@ -0,0 +1,75 @@
+#include "lock_free_queue.hpp"
+#include "queue_poller.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(QueuePollerTest, PriorityOrderAndBatchLimits) {
+    common::LFQueue<int> trades(100), control(100);
+    std::vector<std::string> log;
+    common::QueuePoller poller(
+        common::poll_source(trades, [&](int& v) { log.push_back("t" + std::to_string(v)); }, 0, 2),
+        common::poll_source(control, [&](int& v) { log.push_back("c" + std::to_string(v)); }, 10, 4)
+    );
+    const size_t trades_id = 0, control_id = 1;
+    ASSERT_EQ(poller.size(), 2u);
+
+    for (int i = 0; i < 5; ++i) {
+        trades.push(i);
+    }
+    control.push(0);
+
+    // control first despite being registered second; trades capped at 2
+    ASSERT_EQ(poller.poll(), 3u);
+    ASSERT_EQ(log, (std::vector<std::string>{"c0", "t0", "t1"}));
+    ASSERT_EQ(poller.poll(), 2u);
+    ASSERT_EQ(poller.poll(), 1u);
+    ASSERT_EQ(poller.poll(), 0u);
+
+    const auto& ts = poller.stats(trades_id);
+    ASSERT_EQ(ts.services, 3u);
+    ASSERT_EQ(ts.messages, 5u);
+    ASSERT_EQ(ts.full_batches, 2u);
+    ASSERT_EQ(ts.max_batch, 2u);
+    ASSERT_EQ(poller.stats(control_id).messages, 1u);
+}
+
+TEST(QueuePollerTest, MixedTypesFromManyProducers) {
+    constexpr int numIterations = 1e6;
+    common::LFQueue<int64_t> trades(64);
+    common::LFQueue<double> level2(64);
+    common::LFQueue<std::string> acks(64);
+
+    std::thread trade_feed([&]() {
+        for (int64_t i = 0; i < numIterations; ++i) {
+            while (!trades.push(i));
+        }
+    });
+    std::thread level2_feed([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            while (!level2.push(i * 0.5));
+        }
+    });
+    std::thread gateway([&]() {
+        for (int i = 0; i < numIterations / 100; ++i) {
+            while (!acks.push(std::to_string(i)));
+        }
+    });
+
+    int64_t next_trade = 0, next_level2 = 0, next_ack = 0;
+    common::QueuePoller poller(
+        common::poll_source(trades, [&](int64_t& v) { ASSERT_EQ(v, next_trade++); }, 0, 16),
+        common::poll_source(level2, [&](double& v) { ASSERT_EQ(v, next_level2++ * 0.5); }, 0, 16),
+        common::poll_source(acks, [&](std::string& v) { ASSERT_EQ(v, std::to_string(next_ack++)); }, 1, 4)
+    );
+    while (next_trade < numIterations || next_level2 < numIterations || next_ack < numIterations / 100) {
+        poller.poll();
+    }
+
+    trade_feed.join();
+    level2_feed.join();
+    gateway.join();
+    ASSERT_EQ(poller.stats(2).messages, static_cast<uint64_t>(numIterations / 100));
+}
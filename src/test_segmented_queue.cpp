@@ -0,0 +1,65 @@
+#include "segmented_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+TEST(SegmentedQueueTest, GrowsAndRecyclesOneThread) {
+    common::SegmentedQueue<int, 4> queue(3);
+    ASSERT_EQ(queue.segments_in_use(), 1u);
+    ASSERT_FALSE(queue.pop().has_value());
+
+    // three segments' worth without a single pop
+    for (int i = 0; i < 12; ++i) {
+        queue.push(i);
+    }
+    ASSERT_EQ(queue.segments_in_use(), 3u);
+    for (int i = 0; i < 12; ++i) {
+        ASSERT_EQ(queue.pop(), i);
+    }
+    ASSERT_FALSE(queue.pop().has_value());
+
+    // drained segments go back to the pool, so this fits again
+    for (int i = 0; i < 8; ++i) {
+        queue.push(i);
+    }
+    ASSERT_EQ(queue.segments_in_use(), 3u);
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_EQ(queue.pop(), i);
+    }
+}
+
+TEST(SegmentedQueueTest, DestroysRemainingElements) {
+    auto counter = std::make_shared<int>(0);
+    {
+        common::SegmentedQueue<std::shared_ptr<int>, 4> queue(4);
+        for (int i = 0; i < 10; ++i) {
+            queue.push(counter);
+        }
+        queue.pop();
+        ASSERT_EQ(counter.use_count(), 10);
+    }
+    ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(SegmentedQueueTest, PushPopTwoThreads) {
+    constexpr int numIterations = 1e6;
+    common::SegmentedQueue<std::string, 64> queue(numIterations / 64 + 2);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            queue.push(std::to_string(i));
+        }
+    });
+
+    int next = 0;
+    while (next < numIterations) {
+        if (auto val = queue.pop()) {
+            ASSERT_EQ(*val, std::to_string(next));
+            ++next;
+        }
+    }
+    producer.join();
+    ASSERT_FALSE(queue.pop().has_value());
+}
@@ -0,0 +1,75 @@
+#include "seqlock.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+struct TopOfBook {
+    int64_t seq;
+    double bid;
+    double ask;
+    double last;
+    int64_t check; // == seq, last field so a torn copy is caught
+};
+
+static TopOfBook make_top(int64_t i) {
+    return TopOfBook{i, i * 1.0, i * 1.0 + 0.5, i * 1.0 + 0.25, i};
+}
+
+TEST(SeqlockTest, StoreLoadOneThread) {
+    common::Seqlock<TopOfBook> lock;
+    ASSERT_EQ(lock.version(), 0u);
+    lock.store(make_top(3));
+    ASSERT_EQ(lock.version(), 2u);
+    TopOfBook out;
+    ASSERT_TRUE(lock.try_load(out));
+    ASSERT_EQ(out.seq, 3);
+    ASSERT_EQ(out.ask, 3.5);
+}
+
+TEST(SeqlockTest, SlotsAreCacheLineAligned) {
+    static_assert(alignof(common::Seqlock<TopOfBook>) == common::hardware_destructive_interference_size);
+    static_assert(sizeof(common::Seqlock<TopOfBook>) % common::hardware_destructive_interference_size == 0);
+    common::SnapshotTable<TopOfBook> table(4);
+    table.publish(2, make_top(7));
+    ASSERT_EQ(table.read(2).seq, 7);
+    ASSERT_EQ(table.read(1).seq, 0);
+    ASSERT_EQ(table.version(1), 0u);
+}
+
+TEST(SeqlockTest, ReadersNeverSeeTornSnapshots) {
+    constexpr int numIterations = 1e6;
+    constexpr int numReaders = 3;
+    constexpr int numProducts = 4;
+    common::SnapshotTable<TopOfBook> table(numProducts);
+    std::atomic<bool> done{false};
+
+    std::thread writer([&]() {
+        for (int i = 1; i <= numIterations; ++i) {
+            table.publish(i % numProducts, make_top(i));
+        }
+        done.store(true, std::memory_order_release);
+    });
+    std::vector<std::thread> readers;
+    for (int r = 0; r < numReaders; ++r) {
+        readers.emplace_back([&]() {
+            std::vector<int64_t> last_seen(numProducts, 0);
+            while (!done.load(std::memory_order_acquire)) {
+                for (int p = 0; p < numProducts; ++p) {
+                    const TopOfBook top = table.read(p);
+                    ASSERT_EQ(top.check, top.seq);
+                    ASSERT_EQ(top.last, top.seq * 1.0 + 0.25);
+                    // a product's snapshot only moves forward
+                    ASSERT_GE(top.seq, last_seen[p]);
+                    last_seen[p] = top.seq;
+                }
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& r : readers) {
+        r.join();
+    }
+    ASSERT_EQ(table.read(numIterations % numProducts).seq, numIterations);
+}
@@ -0,0 +1,128 @@
+#include "shm_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct Quote {
+    int64_t seq;
+    double bid;
+    double ask;
+};
+
+static std::string test_name(const std::string& suffix) {
+    return "/hft_test_shm_" + std::to_string(getpid()) + "_" + suffix;
+}
+
+TEST(ShmLFQueueTest, CreateAttachPushPop) {
+    const std::string name = test_name("basic");
+    auto producer = common::ShmLFQueue<Quote>::create(name, 6);
+    ASSERT_NE(producer, nullptr);
+    ASSERT_EQ(producer->capacity(), 8u);
+    auto consumer = common::ShmLFQueue<Quote>::attach(name);
+    ASSERT_NE(consumer, nullptr);
+
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 8; ++i) {
+            ASSERT_TRUE(producer->push(Quote{lap * 8 + i, 1.0, 2.0}));
+        }
+        ASSERT_FALSE(producer->push(Quote{-1, 0, 0}));
+        ASSERT_EQ(consumer->size(), 8u);
+        for (int i = 0; i < 8; ++i) {
+            auto q = consumer->pop();
+            ASSERT_TRUE(q.has_value());
+            ASSERT_EQ(q->seq, lap * 8 + i);
+        }
+        ASSERT_FALSE(consumer->pop().has_value());
+    }
+}
+
+TEST(ShmLFQueueTest, AttachValidation) {
+    const std::string name = test_name("validation");
+    ASSERT_EQ(common::ShmLFQueue<Quote>::attach(name), nullptr); // does not exist yet
+    auto owner = common::ShmLFQueue<Quote>::create(name, 16);
+    ASSERT_NE(owner, nullptr);
+    ASSERT_EQ(common::ShmLFQueue<Quote>::create(name, 16), nullptr); // already exists
+    ASSERT_EQ(common::ShmLFQueue<int32_t>::attach(name), nullptr); // wrong element type
+    ASSERT_NE(common::ShmLFQueue<Quote>::attach(name), nullptr);
+    owner.reset(); // the creator unlinks the name
+    ASSERT_EQ(common::ShmLFQueue<Quote>::attach(name), nullptr);
+}
+
+// a side restarting after a crash attaches to a queue whose cursors have
+// long since moved on
+TEST(ShmLFQueueTest, ReattachToQueueWithTraffic) {
+    const std::string name = test_name("reattach");
+    auto producer = common::ShmLFQueue<Quote>::create(name, 8);
+    ASSERT_NE(producer, nullptr);
+    auto consumer = common::ShmLFQueue<Quote>::attach(name);
+    ASSERT_NE(consumer, nullptr);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(producer->push(Quote{i, 1.0, 2.0}));
+        ASSERT_TRUE(consumer->pop().has_value());
+    }
+
+    // restarted consumer: the queue is empty, nothing to pop
+    consumer = common::ShmLFQueue<Quote>::attach(name);
+    ASSERT_NE(consumer, nullptr);
+    ASSERT_FALSE(consumer->pop().has_value());
+    ASSERT_EQ(consumer->size(), 0u);
+    ASSERT_TRUE(producer->push(Quote{5, 1.0, 2.0}));
+    auto q = consumer->pop();
+    ASSERT_TRUE(q.has_value());
+    ASSERT_EQ(q->seq, 5);
+
+    // restarted producer with the ring full of unread quotes: pushes must
+    // fail instead of overwriting them
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(producer->push(Quote{6 + i, 1.0, 2.0}));
+    }
+    auto restarted = common::ShmLFQueue<Quote>::attach(name);
+    ASSERT_NE(restarted, nullptr);
+    ASSERT_FALSE(restarted->push(Quote{-1, 0, 0}));
+    for (int i = 0; i < 8; ++i) {
+        q = consumer->pop();
+        ASSERT_TRUE(q.has_value());
+        ASSERT_EQ(q->seq, 6 + i);
+    }
+    ASSERT_TRUE(restarted->push(Quote{14, 1.0, 2.0}));
+    q = consumer->pop();
+    ASSERT_TRUE(q.has_value());
+    ASSERT_EQ(q->seq, 14);
+    ASSERT_FALSE(consumer->pop().has_value());
+}
+
+TEST(ShmLFQueueTest, CrossProcess) {
+    constexpr int numIterations = 1e6;
+    const std::string name = test_name("fork");
+    auto consumer = common::ShmLFQueue<Quote>::create(name, 1024);
+    ASSERT_NE(consumer, nullptr);
+
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        // child: the producer process, with its own mapping
+        auto producer = common::ShmLFQueue<Quote>::attach(name);
+        if (producer == nullptr) {
+            _exit(1);
+        }
+        for (int i = 0; i < numIterations; ++i) {
+            while (!producer->push(Quote{i, i * 0.5, i * 0.5 + 1}));
+        }
+        _exit(0);
+    }
+
+    for (int i = 0; i < numIterations; ++i) {
+        std::optional<Quote> q;
+        do {
+            q = consumer->pop();
+        } while (!q.has_value());
+        ASSERT_EQ(q->seq, i);
+        ASSERT_EQ(q->ask, i * 0.5 + 1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+}
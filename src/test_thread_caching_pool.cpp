@@ -0,0 +1,127 @@
+#include "test_threads.hpp"
+#include "thread_caching_pool.hpp"
+#include "lock_free_queue.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Message {
+    int64_t seq_;
+    int64_t from_;
+    std::string payload_;
+};
+
+TEST(ThreadCachingPoolTest, MagazineRefillAndSpill) {
+    common::ThreadCachingPool<Message, 4> pool(1, 32);
+    auto& cache = pool.cache(0);
+    ASSERT_EQ(cache.cached(), 0u);
+
+    Message* first = cache.allocate(Message{1, 0, "a"});
+    // refilled a whole magazine, handed out one
+    ASSERT_EQ(cache.cached(), 3u);
+    cache.deallocate(first);
+    ASSERT_EQ(cache.allocate(Message{2, 0, "b"}), first);
+
+    std::vector<Message*> held{first};
+    std::set<Message*> distinct{first};
+    for (int i = 0; i < 31; ++i) {
+        held.push_back(cache.allocate(Message{i, 0, std::to_string(i)}));
+        distinct.insert(held.back());
+    }
+    ASSERT_EQ(distinct.size(), 32u);
+    ASSERT_EQ(cache.cached(), 0u);
+    // the magazine holds 2 * 4 blocks, every further free spills 4
+    for (Message* m : held) {
+        cache.deallocate(m);
+        ASSERT_LE(cache.cached(), 8u);
+    }
+    // all 32 can be taken again
+    for (int i = 0; i < 32; ++i) {
+        cache.allocate(Message{i, 0, ""});
+    }
+}
+
+TEST(ThreadCachingPoolTest, DestroysLiveObjects) {
+    auto counter = std::make_shared<int>(0);
+    {
+        common::ThreadCachingPool<std::shared_ptr<int>, 4> pool(2, 8);
+        auto* a = pool.cache(0).allocate(counter);
+        pool.cache(0).allocate(counter);
+        pool.cache(1).allocate(counter);
+        // freed ones sit in a magazine or a return queue, not destroyed twice
+        pool.cache(1).deallocate(a);
+        ASSERT_EQ(counter.use_count(), 3);
+    }
+    ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(ThreadCachingPoolTest, RemoteFreeGoesBackToOwner) {
+    common::ThreadCachingPool<Message, 4> pool(2, 8);
+    std::vector<Message*> held;
+    for (int i = 0; i < 8; ++i) {
+        held.push_back(pool.cache(0).allocate(Message{i, 0, ""}));
+    }
+    std::thread other([&]() {
+        for (Message* m : held) {
+            pool.cache(1).deallocate(m);
+        }
+    });
+    other.join();
+    ASSERT_EQ(pool.cache(0).collect(), 8u);
+    ASSERT_EQ(pool.cache(0).cached(), 8u);
+    ASSERT_EQ(pool.cache(1).cached(), 0u);
+}
+
+// a ring of pipeline stages: each stage allocates messages from its own
+// cache, sends them to the next stage, and frees what it receives from
+// the previous one, so every free is remote
+struct Stage {
+    common::ThreadCachingPool<Message, 16>* pool_;
+    common::LFQueue<Message*>* out_;
+    common::LFQueue<Message*>* in_;
+    int64_t id_;
+    int numIterations_;
+};
+
+void stageWork(Stage& stage) {
+    auto& cache = stage.pool_->cache(stage.id_);
+    int64_t sent = 0, received = 0, expected_from = -1;
+    while (sent < stage.numIterations_ || received < stage.numIterations_) {
+        if (sent < stage.numIterations_) {
+            Message* m = cache.allocate(Message{sent, stage.id_, std::to_string(sent)});
+            if (stage.out_->push(m)) {
+                ++sent;
+            } else {
+                cache.deallocate(m);
+            }
+        }
+        if (auto m = stage.in_->pop()) {
+            if (expected_from < 0) {
+                expected_from = (*m)->from_;
+            }
+            EXPECT_EQ((*m)->from_, expected_from);
+            EXPECT_EQ((*m)->seq_, received);
+            EXPECT_EQ((*m)->payload_, std::to_string(received));
+            ++received;
+            cache.deallocate(*m);
+        }
+    }
+}
+
+TEST(ThreadCachingPoolTest, RingOfStagesRemoteFrees) {
+    constexpr int numStages = 4;
+    constexpr int numIterations = 1e5;
+    common::ThreadCachingPool<Message, 16> pool(numStages, 1024, 256);
+    std::vector<std::unique_ptr<common::LFQueue<Message*>>> links;
+    for (int s = 0; s < numStages; ++s) {
+        links.push_back(std::make_unique<common::LFQueue<Message*>>(64));
+    }
+    test::ThreadGroup(numStages, "stage", [&](int s) {
+        Stage stage{&pool, links[s].get(), links[(s + numStages - 1) % numStages].get(), s, numIterations};
+        stageWork(stage);
+    }).join();
+}
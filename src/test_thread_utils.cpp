@@ -66,4 +66,36 @@ TEST(ThreadedFunctionTest, ConcurrentIncrements) {
 
     // Verify the counter's final value
     ASSERT_EQ(counter.load(std::memory_order_relaxed), numThreads);
-}
\ No newline at end of file
+}
+
+TEST(ThreadedFunctionTest, QuietThreadLogsNothing) {
+    std::atomic<int> counter(0);
+    testing::internal::CaptureStdout();
+    std::thread* t = common::create_and_start_thread(
+        common::ThreadLog::Quiet, -1, "test_quiet_counter", concurrent_counter, counter
+    );
+    t->join();
+    delete t;
+    ASSERT_EQ(testing::internal::GetCapturedStdout(), "");
+    ASSERT_EQ(counter.load(std::memory_order_relaxed), 1);
+}
+
+TEST(ScopedThreadCoreTest, RestoresAffinity) {
+    cpu_set_t before;
+    ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(before), &before), 0);
+    {
+        common::ScopedThreadCore pin(0);
+        ASSERT_TRUE(pin.pinned());
+        cpu_set_t during;
+        ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(during), &during), 0);
+        ASSERT_EQ(CPU_COUNT(&during), 1);
+        ASSERT_TRUE(CPU_ISSET(0, &during));
+    }
+    cpu_set_t after;
+    ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(after), &after), 0);
+    ASSERT_TRUE(CPU_EQUAL(&before, &after));
+
+    // -1 leaves the thread alone
+    common::ScopedThreadCore unpinned(-1);
+    ASSERT_FALSE(unpinned.pinned());
+}
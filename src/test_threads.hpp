@@ -0,0 +1,58 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_utils.hpp"
+
+namespace test {
+    /*
+     * `count` unpinned threads started with create_and_start_thread, the
+     * i-th running `work(i)`. create_and_start_thread keeps references to
+     * its arguments, so the group owns the work and the indices until the
+     * threads are joined, by join() or at the latest by the destructor.
+    */
+    class ThreadGroup {
+    public:
+        ThreadGroup(int count, const std::string& name, std::function<void(int)> work) :
+            work_(std::move(work)),
+            ids_(count) {
+                for (int i = 0; i < count; ++i) {
+                    ids_[i] = i;
+                    threads_.emplace_back(common::create_and_start_thread(
+                        -1, name + "_" + std::to_string(i), run, *this, ids_[i]
+                    ));
+                }
+            }
+
+        ~ThreadGroup() {
+            join();
+        }
+
+        ThreadGroup() = delete;
+        ThreadGroup(const ThreadGroup&) = delete;
+        ThreadGroup(const ThreadGroup&&) = delete;
+        ThreadGroup& operator=(const ThreadGroup&) = delete;
+        ThreadGroup& operator=(const ThreadGroup&&) = delete;
+
+        void join() {
+            for (auto& t : threads_) {
+                if (t->joinable()) {
+                    t->join();
+                }
+            }
+        }
+
+    private:
+        static void run(ThreadGroup& group, int& id) {
+            group.work_(id);
+        }
+
+        std::function<void(int)> work_;
+        std::vector<int> ids_;
+        std::vector<std::unique_ptr<std::thread>> threads_;
+    };
+}
@@ -0,0 +1,122 @@
+#include "test_threads.hpp"
+#include "lock_free_queue.hpp"
+#include "mpsc_queue.hpp"
+#include "wait_strategy.hpp"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+template <typename Wait>
+class WaitStrategyTest : public ::testing::Test {};
+
+using WaitPolicies = ::testing::Types<
+    common::SpinWait,
+    common::PauseSpinWait,
+    common::BackoffWait<>,
+    common::ParkingWait<>,
+    common::ParkingWait<0> // parks on the first miss
+>;
+TYPED_TEST_SUITE(WaitStrategyTest, WaitPolicies);
+
+TYPED_TEST(WaitStrategyTest, PushPopTwoThreads) {
+    constexpr int numIterations = 1e6;
+    // small ring so both the producer and the consumer have to wait
+    common::BlockingQueue<common::LFQueue<int>, TypeParam, TypeParam> q(4);
+    std::vector<int> poppedValues(numIterations);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            q.push(i);
+        }
+    });
+    std::thread consumer([&]() {
+        for (int i = 0; i < numIterations; ++i) {
+            poppedValues[i] = q.pop();
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    for (int i = 0; i < numIterations; ++i) {
+        ASSERT_EQ(poppedValues[i], i);
+    }
+}
+
+TEST(ParkingWaitTest, ParkedConsumerIsWoken) {
+    common::BlockingQueue<common::FixedLFQueue<int, 8>, common::ParkingWait<16>> q;
+    int result = 0;
+    std::thread consumer([&]() {
+        result = q.pop();
+    });
+    // long enough for the consumer to exhaust its spins and park
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    q.push(42);
+    consumer.join();
+    ASSERT_EQ(result, 42);
+    ASSERT_FALSE(q.try_pop().has_value());
+}
+
+// one waiter succeeding on its re-check must not hide a second, still
+// parked waiter from notify()
+TEST(ParkingWaitTest, EarlyReturnDoesNotHideParkedWaiter) {
+    struct State {
+        common::ParkingWait<0> wait;
+        std::atomic<bool> ready{false};
+        std::atomic<bool> woken{false};
+    };
+    // shared, so a waiter that is never woken does not outlive it
+    auto state = std::make_shared<State>();
+    std::thread parked([state]() {
+        state->wait.wait([&]() { return state->ready.load(); });
+        state->woken = true;
+    });
+    while (state->wait.waiters() == 0) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    state->wait.wait([]() { return true; });
+    EXPECT_EQ(state->wait.waiters(), 1u);
+
+    state->ready = true;
+    state->wait.notify();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!state->woken && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!state->woken) {
+        parked.detach();
+        FAIL() << "parked waiter was never woken";
+    }
+    parked.join();
+    ASSERT_EQ(state->wait.waiters(), 0u);
+}
+
+void parkingProducerWork(
+    common::BlockingQueue<common::MPSCQueue<int>, common::ParkingWait<16>, common::ParkingWait<16>>& q,
+    int numIterations
+) {
+    for (int i = 0; i < numIterations; ++i) {
+        q.push(i);
+    }
+}
+
+TEST(ParkingWaitTest, ManyParkedProducers) {
+    constexpr int numProducers = 4;
+    constexpr int numIterations = 1e5;
+    common::BlockingQueue<common::MPSCQueue<int>, common::ParkingWait<16>, common::ParkingWait<16>> q(2);
+
+    test::ThreadGroup producers(numProducers, "producer", [&](int) {
+        parkingProducerWork(q, numIterations);
+    });
+    int64_t sum = 0;
+    for (int i = 0; i < numProducers * numIterations; ++i) {
+        sum += q.pop();
+    }
+    producers.join();
+    ASSERT_EQ(sum, int64_t{numProducers} * numIterations * (numIterations - 1) / 2);
+}
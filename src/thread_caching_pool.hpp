@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "lock_free_queue.hpp"
+#include "macros.hpp"
+#include "mem_pool.hpp"
+#include "wait_strategy.hpp"
+
+namespace common {
+    /*
+     * Thread-caching front end over MemPool for a fixed set of pipeline
+     * threads, so that allocation never touches a shared free-list head.
+     *
+     * Thread i owns Cache i: a private MemPool of blocks plus a magazine,
+     * a LIFO stack of free blocks that allocate() and local deallocate()
+     * work on directly, so the most recently freed (cache-hot) block is
+     * reused first. The magazine refills from the MemPool
+     * `MagazineSize` blocks at a time when it runs dry, and spills the
+     * same amount back when it reaches twice that.
+     *
+     * Every block remembers its owner. A block freed by another thread
+     * goes back to the owner through an SPSC LFQueue dedicated to that
+     * (freeing thread, owner) pair, so no queue ever has two producers.
+     * The owner drains its queues in batches when it refills, or on
+     * collect(). If an owner's queue is full the freeing thread waits for
+     * it (collecting its own returns meanwhile), so owners that mostly
+     * receive should call collect() from their loop.
+     *
+     * Each thread must only use its own Cache; it may deallocate blocks
+     * from any Cache through it. Objects still allocated when the pool is
+     * destroyed are destroyed with it, so no thread may still use them.
+    */
+    template <typename T, size_t MagazineSize = 64>
+    class ThreadCachingPool {
+    private:
+        static_assert(MagazineSize > 0, "MagazineSize must be at least 1.");
+
+        struct Block {
+            // leaves the storage alone: refill() takes blocks from the
+            // MemPool by the magazine, and zeroing each one would cost a
+            // write of sizeof(T) per block
+            explicit Block(uint32_t owner) : owner_(owner) {}
+
+            // the MemPool destroys every block it handed out, which takes
+            // the objects still allocated with it
+            ~Block() {
+                if constexpr (!std::is_trivially_destructible_v<T>) {
+                    if (live_) {
+                        std::destroy_at(obj());
+                    }
+                }
+            }
+
+            // first, so a T* is also a Block*
+            RawSlot<T> storage_;
+            uint32_t owner_;
+            bool live_ = false;
+
+            T* obj() {
+                return reinterpret_cast<T*>(storage_.bytes_);
+            }
+        };
+
+    public:
+        class alignas(hardware_destructive_interference_size) Cache {
+        public:
+            template <typename... A>
+            T* allocate(A&&... args) {
+                if (UNLIKELY(count_ == 0)) {
+                    refill();
+                }
+                Block* block = magazine_[--count_];
+                T* obj = new (block->obj()) T(std::forward<A>(args)...);
+                block->live_ = true;
+                return obj;
+            }
+
+            void deallocate(const T* obj) {
+                Block* block = reinterpret_cast<Block*>(const_cast<T*>(obj));
+                std::destroy_at(block->obj());
+                block->live_ = false;
+                if (LIKELY(block->owner_ == id_)) {
+                    put_local(block);
+                    return;
+                }
+                // remote free: hand the block back to its owner. while the
+                // owner's queue is full, take in our own returns so two
+                // threads waiting on each other always make progress
+                LFQueue<Block*>& queue = *owner_.caches_[block->owner_]->inbound_[id_];
+                while (!queue.push(block)) {
+                    collect();
+                    cpu_relax();
+                }
+            }
+
+            // takes back every block other threads freed so far
+            size_t collect() {
+                size_t total = 0;
+                for (auto& queue : inbound_) {
+                    if (queue) {
+                        total += queue->drain([this](Block*& block) { put_local(block); }, SIZE_MAX);
+                    }
+                }
+                return total;
+            }
+
+            // free blocks currently in the magazine
+            size_t cached() const {
+                return count_;
+            }
+
+        private:
+            friend class ThreadCachingPool;
+
+            Cache(ThreadCachingPool& owner, uint32_t id, size_t num_threads, int blocks, int queue_capacity) :
+                owner_(owner),
+                id_(id),
+                pool_(blocks),
+                inbound_(num_threads) {
+                    for (size_t t = 0; t < num_threads; ++t) {
+                        if (t != id) {
+                            inbound_[t] = std::make_unique<LFQueue<Block*>>(queue_capacity);
+                        }
+                    }
+                }
+
+            void put_local(Block* block) {
+                if (UNLIKELY(count_ == magazine_.size())) {
+                    spill();
+                }
+                magazine_[count_++] = block;
+            }
+
+            // remote frees first, they are otherwise stranded; then fresh
+            // blocks from the pool
+            void refill() {
+                for (auto& queue : inbound_) {
+                    if (queue && count_ < MagazineSize) {
+                        count_ += queue->pop_n(&magazine_[count_], MagazineSize - count_);
+                    }
+                }
+                while (count_ < MagazineSize && pool_.size() < pool_.capacity()) {
+                    magazine_[count_++] = pool_.allocate(id_);
+                }
+                if (UNLIKELY(count_ == 0)) {
+                    FATAL("ThreadCachingPool cache " + std::to_string(id_) + " is exhausted");
+                }
+            }
+
+            // oldest half of the magazine back into the pool
+            void spill() {
+                for (size_t i = 0; i < MagazineSize; ++i) {
+                    pool_.deallocate(magazine_[i]);
+                }
+                std::copy(magazine_.begin() + MagazineSize, magazine_.begin() + count_, magazine_.begin());
+                count_ -= MagazineSize;
+            }
+
+            ThreadCachingPool& owner_;
+            const uint32_t id_;
+            std::array<Block*, 2 * MagazineSize> magazine_;
+            size_t count_ = 0;
+            MemPool<Block, UncheckedPool> pool_;
+            // indexed by the freeing thread, null for this thread itself
+            std::vector<std::unique_ptr<LFQueue<Block*>>> inbound_;
+        };
+
+        /*
+         * `blocks_per_thread` is each thread's own pool. `queue_capacity`
+         * bounds each (freeing thread, owner) return queue; remote frees
+         * only wait when the owner lets that many pile up.
+        */
+        ThreadCachingPool(size_t num_threads, int blocks_per_thread, int queue_capacity = 1024) {
+            caches_.reserve(num_threads);
+            for (size_t t = 0; t < num_threads; ++t) {
+                caches_.emplace_back(new Cache(*this, static_cast<uint32_t>(t), num_threads,
+                    blocks_per_thread, queue_capacity));
+            }
+        }
+
+        ThreadCachingPool() = delete;
+        ThreadCachingPool(const ThreadCachingPool&) = delete;
+        ThreadCachingPool(const ThreadCachingPool&&) = delete;
+        ThreadCachingPool& operator=(const ThreadCachingPool&) = delete;
+        ThreadCachingPool& operator=(const ThreadCachingPool&&) = delete;
+
+        // the calling thread's cache; thread_idx in [0, num_threads)
+        Cache& cache(size_t thread_idx) {
+            return *caches_[thread_idx];
+        }
+
+        size_t num_threads() const {
+            return caches_.size();
+        }
+
+    private:
+        std::vector<std::unique_ptr<Cache>> caches_;
+    };
+}
@@ -7,6 +7,8 @@
 #include <pthread.h>
 #include <sys/syscall.h>
 
+#include "numa.hpp"
+
 namespace common {
     inline bool set_thread_core(int core_id) {
         cpu_set_t cpuset;
@@ -18,13 +20,52 @@ namespace common {
 
     }
 
+    // pins the calling thread to `core_id` (-1 leaves it alone) for the
+    // lifetime of the object, then puts back the affinity mask it had
+    class ScopedThreadCore {
+    public:
+        explicit ScopedThreadCore(int core_id) {
+            CPU_ZERO(&saved_);
+            if (core_id >= 0 && pthread_getaffinity_np(pthread_self(), sizeof(saved_), &saved_) == 0) {
+                pinned_ = set_thread_core(core_id);
+            }
+        }
+
+        ~ScopedThreadCore() {
+            if (pinned_) {
+                pthread_setaffinity_np(pthread_self(), sizeof(saved_), &saved_);
+            }
+        }
+
+        ScopedThreadCore(const ScopedThreadCore&) = delete;
+        ScopedThreadCore(const ScopedThreadCore&&) = delete;
+        ScopedThreadCore& operator=(const ScopedThreadCore&) = delete;
+        ScopedThreadCore& operator=(const ScopedThreadCore&&) = delete;
+
+        bool pinned() const {
+            return pinned_;
+        }
+
+    private:
+        cpu_set_t saved_;
+        bool pinned_ = false;
+    };
+
+    // whether create_and_start_thread reports the affinity it set on 
+    // stdout. Quiet is for threads started over and over, e.g. once per 
+    // benchmark run; a failure to pin is reported either way
+    enum class ThreadLog {
+        Verbose,
+        Quiet
+    };
+
     template <typename T, typename... A>
-    inline std::thread* create_and_start_thread(int core_id, std::string name, T&& func, A&&... args) {
+    inline std::thread* create_and_start_thread(ThreadLog log, int core_id, std::string name, T&& func, A&&... args) {
         // these cause a tsan warning
         // std::atomic<bool> running(false), failed(false);
 
         // arg list because otherwise it causes tsan warnings
-        auto thread_body = [core_id, name = std::move(name), func, &args...]() {
+        auto thread_body = [log, core_id, name = std::move(name), func, &args...]() {
             // pass -1 to core_id to avoid setting core affinity
             if (core_id >= 0 && !set_thread_core(core_id)) {
                 std::cerr << "Failed to set core affinity for " << name << " "
@@ -32,8 +73,16 @@ namespace common {
                 // failed.store(true);
                 return;
             }
-            std::cout << " Set core affinity for " << name << " " << pthread_self() 
-            << " to " << core_id << std::endl;
+            // whatever the thread allocates or first-touches from here on
+            // lives on the node it is pinned to
+            const int node = numa_node_of_cpu(core_id);
+            if (core_id >= 0) {
+                numa_prefer_node(node);
+            }
+            if (log == ThreadLog::Verbose) {
+                std::cout << " Set core affinity for " << name << " " << pthread_self() 
+                << " to " << core_id << " (NUMA node " << node << ")" << std::endl;
+            }
 
             // running.store(true);
             std::forward<T>(func) ((std::forward<A>(args))...);
@@ -45,4 +94,11 @@ namespace common {
 
         return t;
     }
+
+    template <typename T, typename... A>
+    inline std::thread* create_and_start_thread(int core_id, std::string name, T&& func, A&&... args) {
+        return create_and_start_thread(
+            ThreadLog::Verbose, core_id, std::move(name), std::forward<T>(func), std::forward<A>(args)...
+        );
+    }
 }
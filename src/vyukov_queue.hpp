@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "cache_line.hpp"
+#include "lock_free_queue.hpp"
+#include "pow2.hpp"
+
+namespace common {
+    /*
+     * Bounded lock-free queue with per-slot sequence numbers (Vyukov),
+     * shared by MPSCQueue and MPMCQueue.
+     *
+     * Every slot carries a sequence number that says whose turn it is:
+     *   seq == pos             free, the producer with ticket `pos` may write
+     *   seq == pos + 1         written, the consumer with ticket `pos` may read
+     *   seq == pos + capacity  read, free again for the next lap
+     * Producers claim a ticket by CAS on the shared tail, construct the
+     * element, then publish it by storing the slot's sequence. A thread
+     * that loses a CAS retries with the cursor it observed; nobody ever
+     * waits on a lock.
+     *
+     * With `MultiConsumer` consumers claim positions by CAS on the head
+     * the way producers do on the tail. Without it there is exactly one
+     * consumer, which owns the head and just stores it.
+     *
+     * Cells, head and tail each get their own cache line. Capacity is
+     * rounded up to a power of two so positions can be masked.
+    */
+    template <typename T, bool MultiConsumer>
+    class VyukovQueue {
+    private:
+        static_assert(
+            std::atomic<size_t>::is_always_lock_free,
+            "atomic size_t is not lock-free."
+        );
+
+        // one cell per cache line: producers writing neighbouring slots
+        // would otherwise invalidate each other's line
+        struct alignas(hardware_destructive_interference_size) Cell {
+            std::atomic<size_t> seq_;
+            RawSlot<T> storage_;
+
+            T* obj() {
+                return reinterpret_cast<T*>(storage_.bytes_);
+            }
+        };
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+
+        // shared by all producers
+        alignas(hardware_destructive_interference_size) std::atomic<size_t> tail_{};
+        // shared by all consumers, or written only by the single consumer
+        // (atomic then so size() can read it)
+        alignas(hardware_destructive_interference_size) std::atomic<size_t> head_{};
+
+    public:
+        explicit VyukovQueue(int capacity) :
+            capacity_(round_up_pow2(capacity)),
+            mask_(capacity_ - 1),
+            cells_(new Cell[capacity_]) {
+                for (size_t i = 0; i < capacity_; ++i) {
+                    cells_[i].seq_.store(i, std::memory_order_relaxed);
+                }
+            }
+
+        ~VyukovQueue() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                while (pop().has_value());
+            }
+        }
+
+        VyukovQueue() = delete;
+        VyukovQueue(const VyukovQueue&) = delete;
+        VyukovQueue(const VyukovQueue&&) = delete;
+        VyukovQueue& operator=(const VyukovQueue&) = delete;
+        VyukovQueue& operator=(const VyukovQueue&&) = delete;
+
+        // safe to call from any number of threads
+        template <typename U>
+        bool push(U&& obj) {
+            static_assert(
+                std::is_same<T, std::decay_t<U>>::value,
+                "Type U must be the same as the queue element type T"
+            );
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;) {
+                cell = &cells_[pos & mask_];
+                const size_t seq = cell->seq_.load(std::memory_order_acquire);
+                const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    // slot is free for this lap, try to take the ticket.
+                    // on failure `pos` is refreshed with the current tail
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    // not yet read on the previous lap: full
+                    return false;
+                } else {
+                    // another producer took this ticket, catch up
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+            new (cell->obj()) T(std::forward<U>(obj));
+            cell->seq_.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // any number of threads with MultiConsumer, otherwise one
+        std::optional<T> pop() {
+            size_t pos = head_.load(std::memory_order_relaxed);
+            Cell* cell;
+            if constexpr (MultiConsumer) {
+                for (;;) {
+                    cell = &cells_[pos & mask_];
+                    const size_t seq = cell->seq_.load(std::memory_order_acquire);
+                    const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                    if (diff == 0) {
+                        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    } else if (diff < 0) {
+                        // not yet written on this lap: empty
+                        return std::nullopt;
+                    } else {
+                        // another consumer took this ticket, catch up
+                        pos = head_.load(std::memory_order_relaxed);
+                    }
+                }
+            } else {
+                cell = &cells_[pos & mask_];
+                // empty, or the producer holding this ticket has not
+                // published yet
+                if (cell->seq_.load(std::memory_order_acquire) != pos + 1) {
+                    return std::nullopt;
+                }
+            }
+            std::optional<T> out(std::move(*cell->obj()));
+            std::destroy_at(cell->obj());
+            // hand the slot to whichever producer gets ticket pos + capacity
+            cell->seq_.store(pos + capacity_, std::memory_order_release);
+            if constexpr (!MultiConsumer) {
+                head_.store(pos + 1, std::memory_order_relaxed);
+            }
+            return out;
+        }
+
+        // approximate while the queue is in use: tail is claimed before the
+        // element is written and either cursor may be read stale, so the
+        // difference is clamped to [0, capacity]
+        size_t size() const {
+            const size_t head = head_.load(std::memory_order_acquire);
+            const size_t tail = tail_.load(std::memory_order_acquire);
+            const auto n = static_cast<intptr_t>(tail) - static_cast<intptr_t>(head);
+            if (n < 0) {
+                return 0;
+            }
+            return static_cast<size_t>(n) > capacity_ ? capacity_ : static_cast<size_t>(n);
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+    };
+}
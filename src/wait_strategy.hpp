@@ -0,0 +1,230 @@
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#endif
+
+#include "cache_line.hpp"
+
+namespace common {
+    // tell the core we are in a spin loop: on x86 this yields pipeline
+    // resources to the sibling hyperthread and avoids the memory order
+    // mis-speculation penalty when the awaited line finally changes
+    inline void cpu_relax() {
+        #if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+        #else
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        #endif
+    }
+
+    /*
+     * Wait policies. Each one provides
+     *   wait(ready)  call `ready()` until it returns true
+     *   notify()     called by the other side after it made progress
+     * `ready` may have side effects (it is usually a push or pop attempt)
+     * and wait() returns right after the call that returned true.
+    */
+
+    // burns the core, lowest possible wake-up latency
+    struct SpinWait {
+        template <typename F>
+        void wait(F&& ready) {
+            while (!ready());
+        }
+
+        void notify() {}
+    };
+
+    // as SpinWait, with a pause instruction per failed attempt
+    struct PauseSpinWait {
+        template <typename F>
+        void wait(F&& ready) {
+            while (!ready()) {
+                cpu_relax();
+            }
+        }
+
+        void notify() {}
+    };
+
+    // pauses twice as long after every failed attempt, up to `MaxPauses`
+    // per attempt, after which it yields the core to the scheduler
+    template <unsigned MaxPauses = 1024>
+    struct BackoffWait {
+        template <typename F>
+        void wait(F&& ready) {
+            unsigned pauses = 1;
+            while (!ready()) {
+                if (pauses <= MaxPauses) {
+                    for (unsigned i = 0; i < pauses; ++i) {
+                        cpu_relax();
+                    }
+                    pauses <<= 1;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void notify() {}
+    };
+
+    /*
+     * Spins `SpinCount` attempts, then parks the waiting thread on a futex.
+     *
+     * notify() only makes a syscall when a waiter is actually parked; on
+     * the fast path it costs one locked RMW on a line waiters only write
+     * when they are about to sleep. Any number of threads may wait:
+     * notify() wakes all of them and the losers simply park again.
+     *
+     * Parked threads are counted rather than flagged, so a waiter whose
+     * re-check succeeds only takes itself out and never hides the others
+     * from notify(). They sleep on a separate epoch word that notify()
+     * bumps, so a notify landing between a waiter's re-check and its
+     * FUTEX_WAIT makes the wait return at once.
+    */
+    template <unsigned SpinCount = 4096>
+    class ParkingWait {
+    public:
+        template <typename F>
+        void wait(F&& ready) {
+            for (unsigned i = 0; i < SpinCount; ++i) {
+                if (ready()) {
+                    return;
+                }
+                cpu_relax();
+            }
+            for (;;) {
+                // the RMW orders the count before re-checking the queue.
+                // pairs with the RMW in notify(): either we see the new
+                // element, or the notifier sees us counted and wakes us
+                waiters_.fetch_add(1, std::memory_order_seq_cst);
+                const uint32_t epoch = epoch_.load(std::memory_order_acquire);
+                if (ready()) {
+                    waiters_.fetch_sub(1, std::memory_order_relaxed);
+                    return;
+                }
+                // returns immediately if a notify bumped the epoch since
+                futex(FUTEX_WAIT_PRIVATE, epoch);
+                waiters_.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        void notify() {
+            // an RMW rather than a load, so it cannot be reordered before
+            // the caller's push the way a plain load could
+            if (waiters_.fetch_add(0, std::memory_order_seq_cst) != 0) {
+                epoch_.fetch_add(1, std::memory_order_release);
+                futex(FUTEX_WAKE_PRIVATE, INT_MAX);
+            }
+        }
+
+        // threads currently between parking and waking up
+        uint32_t waiters() const {
+            return waiters_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static_assert(
+            sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+            "futex word must be a plain 32-bit integer"
+        );
+
+        long futex(int op, uint32_t val) {
+            return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), op, val, nullptr, nullptr, 0);
+        }
+
+        alignas(hardware_destructive_interference_size) std::atomic<uint32_t> waiters_{0};
+        // the futex word
+        std::atomic<uint32_t> epoch_{0};
+    };
+
+    /*
+     * Blocking push/pop on top of any queue with the LFQueue surface
+     * (LFQueue, FixedLFQueue, MPSCQueue). The consumer waits with
+     * `ConsumerWait` while the queue is empty and the producer waits with
+     * `ProducerWait` while it is full; each side notifies the other's
+     * policy after it makes progress.
+     *
+     * e.g. a logging queue that should not eat a core:
+     *   BlockingQueue<LFQueue<LogLine>, ParkingWait<>> q(1024);
+    */
+    template <typename Queue, typename ConsumerWait = SpinWait, typename ProducerWait = SpinWait>
+    class BlockingQueue {
+    public:
+        using value_type = typename decltype(std::declval<Queue&>().pop())::value_type;
+
+        template <typename... A>
+        explicit BlockingQueue(A&&... args) : queue_(std::forward<A>(args)...) {}
+
+        BlockingQueue(const BlockingQueue&) = delete;
+        BlockingQueue(const BlockingQueue&&) = delete;
+        BlockingQueue& operator=(const BlockingQueue&) = delete;
+        BlockingQueue& operator=(const BlockingQueue&&) = delete;
+
+        // the queue only moves from `obj` once the push succeeds
+        template <typename U>
+        void push(U&& obj) {
+            producer_wait_.wait([&]() { return queue_.push(std::forward<U>(obj)); });
+            consumer_wait_.notify();
+        }
+
+        value_type pop() {
+            std::optional<value_type> val;
+            consumer_wait_.wait([&]() {
+                val = queue_.pop();
+                return val.has_value();
+            });
+            producer_wait_.notify();
+            return std::move(*val);
+        }
+
+        template <typename U>
+        bool try_push(U&& obj) {
+            if (!queue_.push(std::forward<U>(obj))) {
+                return false;
+            }
+            consumer_wait_.notify();
+            return true;
+        }
+
+        std::optional<value_type> try_pop() {
+            auto val = queue_.pop();
+            if (val.has_value()) {
+                producer_wait_.notify();
+            }
+            return val;
+        }
+
+        size_t size() const {
+            return queue_.size();
+        }
+
+        Queue& queue() {
+            return queue_;
+        }
+
+        // e.g. for an event loop that needs the fd of an EventFdWait
+        ConsumerWait& consumer_wait() {
+            return consumer_wait_;
+        }
+
+    private:
+        Queue queue_;
+        ConsumerWait consumer_wait_;
+        ProducerWait producer_wait_;
+    };
+}